@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Arena.cpp                                                        //
+//                                                                           //
+// MODULE:  Memory                                                           //
+//                                                                           //
+// NOTES:   None.                                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include "Arena.hpp"
+
+namespace memory {
+  // the strictest alignment of the types an arena holds
+  union Aligned {
+    double d;
+    long double ld;
+    int64_t i;
+    void* p;
+    void (*f)();
+  };
+
+  static const size_t ALIGNMENT = sizeof(Aligned);
+
+  // chunks stop growing at this size, so that little is left unused at
+  // the end of the last one
+  static const size_t MAX_CHUNK = 16 * 1024 * 1024;
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Arena implementation                                                    //
+  /////////////////////////////////////////////////////////////////////////////
+  Arena::Arena(size_t chunk)
+    : _chunks(),
+      _next(0),
+      _end(0),
+      _first_chunk(chunk > 0 ? chunk : ALIGNMENT),
+      _chunk(_first_chunk),
+      _used(0),
+      _reserved(0),
+      _peak(0)
+  {
+  }
+
+  Arena::~Arena() {
+    release();
+  }
+
+  void* Arena::allocate(size_t bytes) {
+    bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if(bytes == 0)
+      bytes = ALIGNMENT;
+    if(size_t(_end - _next) < bytes)
+      grow(bytes);
+    void* p = _next;
+    _next += bytes;
+    _used += bytes;
+    return p;
+  }
+
+  void Arena::grow(size_t bytes) {
+    size_t size = _chunk < bytes ? bytes : _chunk;
+    // operator new aligns for any object
+    char* chunk = static_cast<char*>(::operator new(size));
+    _chunks.push_back(chunk);
+    _next = chunk;
+    _end = chunk + size;
+    _reserved += size;
+    if(_peak < _reserved)
+      _peak = _reserved;
+    if(_chunk < MAX_CHUNK)
+      _chunk *= 2;
+  }
+
+  void Arena::release() {
+    for(unsigned int i = 0; i < _chunks.size(); ++i)
+      ::operator delete(_chunks[i]);
+    _chunks.clear();
+    _next = _end = 0;
+    _chunk = _first_chunk;
+    _used = 0;
+    _reserved = 0;
+  }
+
+  size_t Arena::used() const {
+    return _used;
+  }
+
+  size_t Arena::reserved() const {
+    return _reserved;
+  }
+
+  size_t Arena::peak() const {
+    return _peak;
+  }
+}
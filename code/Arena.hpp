@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Arena.hpp                                                        //
+//                                                                           //
+// MODULE:  Memory                                                           //
+//                                                                           //
+// PURPOSE: A monotonic arena, from which many small objects are allocated   //
+//          one after another and all released at once.                      //
+//                                                                           //
+// NOTES:   The memory is taken from the heap in chunks, each twice the      //
+//          size of the last up to a limit, and handed out from the front    //
+//          of the newest chunk.  Nothing is freed until release() or the    //
+//          destruction of the arena, which free the chunks and run no       //
+//          destructors, so it only holds objects with trivial ones.         //
+//          Objects allocated one after another lie next to each other.      //
+//                                                                           //
+//          An arena is not thread safe.                                     //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// Arena(chunk)                         starts with chunks of chunk bytes    //
+// allocate(bytes)                      bytes aligned for any object         //
+// create<T>()                          a value-initialized T                //
+// release()                            frees every chunk                    //
+// used()                               the bytes allocated since the last   //
+//                                      release                              //
+// reserved()                           the bytes of the chunks held         //
+// peak()                               the most bytes ever reserved         //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+namespace memory {
+
+  class Arena {
+  public:
+    Arena(size_t chunk = 64 * 1024);
+    ~Arena();
+
+    void* allocate(size_t bytes);
+
+    template <class T>
+    T* create() {
+      return new(allocate(sizeof(T))) T();
+    }
+
+    void release();
+
+    size_t used() const;
+    size_t reserved() const;
+    size_t peak() const;
+
+  private:
+    void grow(size_t bytes);
+
+    // not copyable
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    vector<char*> _chunks;
+    char* _next;
+    char* _end;
+    size_t _first_chunk;
+    size_t _chunk;
+    size_t _used;
+    size_t _reserved;
+    size_t _peak;
+  };
+}
+
+#endif
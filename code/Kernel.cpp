@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Kernel.cpp                                                       //
+//                                                                           //
+// MODULE:  Geometry                                                         //
+//                                                                           //
+// NOTES:   None.                                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+#include "Kernel.hpp"
+
+namespace geometry {
+  /////////////////////////////////////////////////////////////////////////////
+  // PredicateStatistics implementation                                      //
+  /////////////////////////////////////////////////////////////////////////////
+  __thread unsigned long PredicateStatistics::evaluations = 0;
+  __thread unsigned long PredicateStatistics::filter_failures = 0;
+
+  void PredicateStatistics::reset() {
+    evaluations = 0;
+    filter_failures = 0;
+  }
+
+#ifndef GEOMETRY_NO_LEDA
+  /////////////////////////////////////////////////////////////////////////////
+  // RationalKernel implementation                                           //
+  /////////////////////////////////////////////////////////////////////////////
+  int RationalKernel::exact_orientation(const coord_t& ax, const coord_t& ay,
+					const coord_t& bx, const coord_t& by,
+					const coord_t& cx, const coord_t& cy) {
+    coord_t det = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    if(det > 0)
+      return 1;
+    if(det < 0)
+      return -1;
+    return 0;
+  }
+#endif
+}
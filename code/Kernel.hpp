@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Kernel.hpp                                                       //
+//                                                                           //
+// MODULE:  Geometry                                                         //
+//                                                                           //
+// PURPOSE: Geometry kernels.  A kernel fixes the coordinate type used by    //
+//          BasicPoint2D, BasicLineSegment and BasicPolygonalSubdivision     //
+//          and supplies the orientation predicate they are built on.        //
+//                                                                           //
+// NOTES:   Three kernels are built into the library:                        //
+//            Int64Kernel    - exact, 128 bit intermediates, |coord| < 2^62  //
+//            DoubleKernel   - fast, not robust near degeneracies            //
+//            RationalKernel - exact LEDA rationals with a floating-point    //
+//                             filter (omitted when GEOMETRY_NO_LEDA is set) //
+//                                                                           //
+//          DefaultKernel is RationalKernel, or Int64Kernel without LEDA,    //
+//          unless GEOMETRY_DOUBLE_KERNEL ("make kernel=double") makes it    //
+//          DoubleKernel.                                                    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Kernel requirements:                 Description:                         //
+// --------------------                 ------------                         //
+// typedef coord_t                      the coordinate type                  //
+// bool is_exact                        predicates never err                 //
+// bool is_field                        coord_t division is exact            //
+// bool is_pod                          coord_t may be copied as raw bytes   //
+// double to_double(coord_t)            an approximation of a coordinate     //
+// int orientation(a,b,c)               1 left turn, -1 right, 0 colinear    //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef KERNEL_HPP
+#define KERNEL_HPP
+
+#include <stdint.h>
+#include <cfloat>
+#include <cmath>
+
+#ifndef GEOMETRY_NO_LEDA
+#include <LEDA/numbers/rational.h>
+
+using leda::rational;
+#endif
+
+namespace geometry {
+  __extension__ typedef __int128 int128_t;
+
+  /////////////////////////////////////////////////////////////////////////////
+  // PredicateStatistics                                                     //
+  //                                                                         //
+  // Counts calls to the orientation predicate and how many of them the      //
+  // floating-point filter could not decide, falling back to exact           //
+  // arithmetic.  Only filtered kernels report failures.  The calls are only //
+  // counted in a build with GEOMETRY_PREDICATE_STATISTICS defined, as "make //
+  // stats=yes" does for every translation unit alike, so that the           //
+  // predicates of the queries do not otherwise pay for a count nothing      //
+  // reads.  The counts are kept per thread, so concurrent queries neither   //
+  // race nor share a cache line; reset() clears those of the calling        //
+  // thread.                                                                 //
+  /////////////////////////////////////////////////////////////////////////////
+  struct PredicateStatistics {
+    static __thread unsigned long evaluations;
+    static __thread unsigned long filter_failures;
+
+    static void reset();
+  };
+
+#ifdef GEOMETRY_PREDICATE_STATISTICS
+#define GEOMETRY_COUNT_EVALUATION() (++PredicateStatistics::evaluations)
+#else
+#define GEOMETRY_COUNT_EVALUATION() ((void)0)
+#endif
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Int64Kernel                                                             //
+  /////////////////////////////////////////////////////////////////////////////
+  struct Int64Kernel {
+    typedef int64_t coord_t;
+    static const bool is_exact = true;
+    static const bool is_field = false;
+    static const bool is_pod = true;
+
+    static double to_double(const coord_t& v) {
+      return double(v);
+    }
+
+    // differences of coordinates below 2^62 fit in 63 bits, so both
+    // products and their difference fit in a signed 128 bit integer
+    template <class Point>
+    static int orientation(const Point& a, const Point& b, const Point& c) {
+      GEOMETRY_COUNT_EVALUATION();
+      int128_t det =
+	(int128_t(b.x) - a.x) * (int128_t(c.y) - a.y) -
+	(int128_t(b.y) - a.y) * (int128_t(c.x) - a.x);
+      return (det > 0) - (det < 0);
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // DoubleKernel                                                            //
+  /////////////////////////////////////////////////////////////////////////////
+  struct DoubleKernel {
+    typedef double coord_t;
+    static const bool is_exact = false;
+    static const bool is_field = true;
+    static const bool is_pod = true;
+
+    static double to_double(const coord_t& v) {
+      return v;
+    }
+
+    template <class Point>
+    static int orientation(const Point& a, const Point& b, const Point& c) {
+      GEOMETRY_COUNT_EVALUATION();
+      double det = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+      return (det > 0) - (det < 0);
+    }
+  };
+
+#ifndef GEOMETRY_NO_LEDA
+  /////////////////////////////////////////////////////////////////////////////
+  // RationalKernel                                                          //
+  /////////////////////////////////////////////////////////////////////////////
+  struct RationalKernel {
+    typedef rational coord_t;
+    static const bool is_exact = true;
+    static const bool is_field = true;
+    static const bool is_pod = false;
+
+    // rational::to_double() is accurate to 3 ulps, so every approximated
+    // coordinate carries a relative error of at most 6u (u = 2^-53).
+    // Pushing that through the differences, the two products and the
+    // final subtraction bounds the error of the determinant by 16u times
+    // the sum of the magnitude products; 20u leaves room for the rounding
+    // of the bound itself.  Coordinates too small for a normalized double
+    // lose their relative accuracy, hence the absolute term.
+    static double orientation_error() { return 10.0 * DBL_EPSILON; }
+    static double orientation_absolute_error() { return DBL_MIN; }
+
+    static double to_double(const coord_t& v) {
+      return v.to_double();
+    }
+
+    template <class Point>
+    static int orientation(const Point& a, const Point& b, const Point& c) {
+      GEOMETRY_COUNT_EVALUATION();
+
+      double ax = a.x.to_double(), ay = a.y.to_double();
+      double bx = b.x.to_double(), by = b.y.to_double();
+      double cx = c.x.to_double(), cy = c.y.to_double();
+
+      double det = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+
+      // the error of each difference is relative to its operands, not to
+      // the (possibly cancelled) result, so the bound uses their magnitudes
+      double bound = orientation_error() *
+	((std::fabs(bx) + std::fabs(ax)) * (std::fabs(cy) + std::fabs(ay)) +
+	 (std::fabs(by) + std::fabs(ay)) * (std::fabs(cx) + std::fabs(ax)))
+	+ orientation_absolute_error();
+
+      // an overflow makes det or bound non-finite, so both tests fail
+      if(det > bound)
+	return 1;
+      if(-det > bound)
+	return -1;
+
+      ++PredicateStatistics::filter_failures;
+      return exact_orientation(a.x,a.y,b.x,b.y,c.x,c.y);
+    }
+
+    static int exact_orientation(const coord_t& ax, const coord_t& ay,
+				 const coord_t& bx, const coord_t& by,
+				 const coord_t& cx, const coord_t& cy);
+  };
+#endif
+
+#if defined(GEOMETRY_DOUBLE_KERNEL)
+  typedef DoubleKernel DefaultKernel;
+#elif !defined(GEOMETRY_NO_LEDA)
+  typedef RationalKernel DefaultKernel;
+#else
+  typedef Int64Kernel DefaultKernel;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GEOMETRY_FOR_EACH_KERNEL(M) expands M(kernel) for every built-in kernel;  //
+// the translation units use it to explicitly instantiate their templates.   //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef GEOMETRY_NO_LEDA
+#define GEOMETRY_FOR_EACH_KERNEL(M)					\
+  M(geometry::Int64Kernel) M(geometry::DoubleKernel) M(geometry::RationalKernel)
+#else
+#define GEOMETRY_FOR_EACH_KERNEL(M)					\
+  M(geometry::Int64Kernel) M(geometry::DoubleKernel)
+#endif
+
+#endif
@@ -13,86 +13,97 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <cassert>
+#include <string>
 #include "LineSegment.hpp"
+#include "Trace.hpp"
 
-// DEBUG
-#include <iostream>
 using namespace std;
 
 namespace geometry {
 
-  LineSegment::LineSegment(int ax, int ay, int bx, int by)
-    : first(ax,ay), second(bx,by)
+  template <class Kernel>
+  BasicLineSegment<Kernel>::BasicLineSegment(int ax, int ay, int bx, int by)
   {
-    build();
+    build(point_t(ax,ay),point_t(bx,by));
   }
   
-  LineSegment::LineSegment(Point2D& a, Point2D& b)
-    : first(a), second(b)
+  template <class Kernel>
+  BasicLineSegment<Kernel>::BasicLineSegment(point_t& a, point_t& b)
   {
-    if(a.x < b.x) {
-      left = a;
-      right = b;
-    } else {
-      left = b;
-      right = a;
-    }
-    if(a.y < b.y) {
-      bottom = a;
-      top = b;
-    } else {
-      bottom = b;
-      top = a;
-    }
+    build(a,b);
   }
   
-  LineSegment::LineSegment(const Point2D& a, const Point2D& b)
-    : first(a), second(b)
+  template <class Kernel>
+  BasicLineSegment<Kernel>::BasicLineSegment(const point_t& a, const point_t& b)
   {
-    if(a.x < b.x) {
-      left = a;
-      right = b;
-    } else {
-      left = b;
-      right = a;
-    }
-    if(a.y < b.y) {
-      bottom = a;
-      top = b;
-    } else {
-      bottom = b;
-      top = a;
-    }
+    build(a,b);
   }
 
-  LineSegment::~LineSegment() {}
+  template <class Kernel>
+  BasicLineSegment<Kernel>::~BasicLineSegment() {}
 
-  const Point2D& LineSegment::getFirstEndPoint()  const { return first;  }
-  const Point2D& LineSegment::getSecondEndPoint() const { return second; }
+  template <class Kernel>
+  const typename BasicLineSegment<Kernel>::point_t&
+  BasicLineSegment<Kernel>::getFirstEndPoint() const {
+    return (flags & FIRST_IS_RIGHT) ? right : left;
+  }
 
-  const Point2D& LineSegment::getLeftEndPoint()   const { return left;   }
-  const Point2D& LineSegment::getRightEndPoint()  const { return right;  }
-  const Point2D& LineSegment::getTopEndPoint()    const { return top;    }
-  const Point2D& LineSegment::getBottomEndPoint() const { return bottom; }
+  template <class Kernel>
+  const typename BasicLineSegment<Kernel>::point_t&
+  BasicLineSegment<Kernel>::getSecondEndPoint() const {
+    return (flags & FIRST_IS_RIGHT) ? left : right;
+  }
 
-  const bool LineSegment::isVertical() const {
-    return first.x == second.x;
+  template <class Kernel>
+  const typename BasicLineSegment<Kernel>::point_t&
+  BasicLineSegment<Kernel>::getLeftEndPoint()   const { return left;   }
+  template <class Kernel>
+  const typename BasicLineSegment<Kernel>::point_t&
+  BasicLineSegment<Kernel>::getRightEndPoint()  const { return right;  }
+
+  template <class Kernel>
+  const typename BasicLineSegment<Kernel>::point_t&
+  BasicLineSegment<Kernel>::getTopEndPoint() const {
+    return (flags & BOTTOM_IS_RIGHT) ? left : right;
+  }
+
+  template <class Kernel>
+  const typename BasicLineSegment<Kernel>::point_t&
+  BasicLineSegment<Kernel>::getBottomEndPoint() const {
+    return (flags & BOTTOM_IS_RIGHT) ? right : left;
+  }
+
+  template <class Kernel>
+  const bool BasicLineSegment<Kernel>::isVertical() const {
+    return (flags & VERTICAL) != 0;
   }
 
-  const bool LineSegment::isHorizontal() const {
-    return first.y == second.y;
+  template <class Kernel>
+  const bool BasicLineSegment<Kernel>::isHorizontal() const {
+    return (flags & HORIZONTAL) != 0;
   }
 
-  IntersectionResult LineSegment::intersection(const LineSegment& other) const {
+  // the parameters of the intersection are quotients, which a kernel
+  // that is not a field (Int64Kernel) would truncate, and its cross
+  // products could overflow coord_t, so such kernels are refused
+  template <class Kernel>
+  BasicIntersectionResult<Kernel>
+  BasicLineSegment<Kernel>::intersection(const BasicLineSegment& other) const {
     ///////////////////////////////////////////////////////////////////////////
     // From the theory on:                                                   //
     // http://paulbourke.net/geometry/lineline2d/                            //
     ///////////////////////////////////////////////////////////////////////////
-    IntersectionResult result;
-    coord_t denom = Point2D::crossProduct(second-first,other.second-other.first);
-    coord_t num_a = Point2D::crossProduct(other.second-other.first,
-					  first-other.first);
-    coord_t num_b = Point2D::crossProduct(second-first,first-other.first);
+    if(!Kernel::is_field)
+      throw string("Segment intersection needs a field kernel");
+    BasicIntersectionResult<Kernel> result;
+    const point_t& first = getFirstEndPoint();
+    const point_t& second = getSecondEndPoint();
+    const point_t& other_first = other.getFirstEndPoint();
+    const point_t& other_second = other.getSecondEndPoint();
+    coord_t denom = point_t::crossProduct(second-first,other_second-other_first);
+    coord_t num_a = point_t::crossProduct(other_second-other_first,
+					  first-other_first);
+    coord_t num_b = point_t::crossProduct(second-first,first-other_first);
 
     if(denom == 0) {
       if(num_a == 0 && num_b == 0)
@@ -106,15 +117,15 @@ namespace geometry {
     coord_t ub = num_b / denom;
 
     if(ua >= 0 && ua <= 1 && ub >= 0 && ub <= 1) {
-      result.point = Point2D(first.x + ua * (second.x - first.x),
+      result.point = point_t(first.x + ua * (second.x - first.x),
 			     first.y + ua * (second.y - first.y));
       result.isIntersecting = true;
     }
     return result;
   }
 
-  bool LineSegment::operator<(const LineSegment& other) const {
-    clog << *this << " < " << other << endl;
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::operator<(const BasicLineSegment& other) const {
     bool yasc_flag, ydesc_flag, xasc_flag, xdesc_flag;
     if(this->getLeftEndPoint().x < other.getLeftEndPoint().x) {
       ydesc_flag = ydesc(*this,other);
@@ -131,37 +142,47 @@ namespace geometry {
       xdesc_flag = xasc(other,*this);
     }
     if(ydesc_flag) {
-      clog << "ydesc flag" << endl;
+      TRACE(TRACE_COMPARATOR,TRACE_VERBOSE,
+	    *this << " < " << other << ": ydesc flag");
       return true;
     } else if(yasc_flag) {
-      clog << "yasc flag" << endl;
+      TRACE(TRACE_COMPARATOR,TRACE_VERBOSE,
+	    *this << " < " << other << ": yasc flag");
       return false;
     } else if(xdesc_flag) {
-      clog << "xdesc flag" << endl;
+      TRACE(TRACE_COMPARATOR,TRACE_VERBOSE,
+	    *this << " < " << other << ": xdesc flag");
       return true;
     } else if(xasc_flag) {
-      clog << "xasc flag" << endl;
+      TRACE(TRACE_COMPARATOR,TRACE_VERBOSE,
+	    *this << " < " << other << ": xasc flag");
       return false;
     }
-    clog << "equal?" << endl;
+    TRACE(TRACE_COMPARATOR,TRACE_VERBOSE,
+	  *this << " < " << other << ": equal?");
     // xasc or equal
     return false;
   }
 
-  bool LineSegment::operator>(const LineSegment& other) const {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::operator>(const BasicLineSegment& other) const {
     return !operator==(other) && !operator<(other);
   }
 
-  bool LineSegment::operator<=(const LineSegment& other) const {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::operator<=(const BasicLineSegment& other) const {
     return !operator>(other);
   }
 
-  bool LineSegment::operator>=(const LineSegment& other) const {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::operator>=(const BasicLineSegment& other) const {
     return !operator<(other);
   }
 
   // returns true if left belongs above right in descending order
-  bool LineSegment::ydesc(const LineSegment& left, const LineSegment& right) {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::ydesc(const BasicLineSegment& left,
+				       const BasicLineSegment& right) {
     // both vertical
     if(left.isVertical() && right.isVertical()) {
       if(left.getBottomEndPoint().y > right.getBottomEndPoint().y)
@@ -174,28 +195,30 @@ namespace geometry {
     if(left.isVertical())
       return left.getBottomEndPoint().y > right.getLeftEndPoint().y;
     // left.left, left.right, right.left colinear
-    if(Point2D::colinear(left.getLeftEndPoint(),
+    if(point_t::colinear(left.getLeftEndPoint(),
 			 left.getRightEndPoint(),
 			 right.getLeftEndPoint())) {
       // all points colinear
-      if(Point2D::colinear(left.getLeftEndPoint(),
+      if(point_t::colinear(left.getLeftEndPoint(),
 			   left.getRightEndPoint(),
 			   right.getRightEndPoint())) {
 	return left.getBottomEndPoint().y > right.getBottomEndPoint().y;
       }
       // only 3 colinear
-      return Point2D::rightTurn(left.getLeftEndPoint(),
+      return point_t::rightTurn(left.getLeftEndPoint(),
 				left.getRightEndPoint(),
 				right.getRightEndPoint());
     }
     // normal case
-    return Point2D::rightTurn(left.getLeftEndPoint(),
+    return point_t::rightTurn(left.getLeftEndPoint(),
 			      left.getRightEndPoint(),
 			      right.getLeftEndPoint());
   }
 
   // returns true if left belongs above right in ascending order
-  bool LineSegment::yasc(const LineSegment& left, const LineSegment& right) {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::yasc(const BasicLineSegment& left,
+				      const BasicLineSegment& right) {
     // both vertical
     if(left.isVertical() && right.isVertical()) {
       if(left.getBottomEndPoint().y < right.getBottomEndPoint().y)
@@ -208,27 +231,29 @@ namespace geometry {
     if(left.isVertical())
       return left.getBottomEndPoint().y < right.getLeftEndPoint().y;
     // left.left, left.right, right.left colinear
-    if(Point2D::colinear(left.getLeftEndPoint(),
+    if(point_t::colinear(left.getLeftEndPoint(),
 			 left.getRightEndPoint(),
 			 right.getLeftEndPoint())) {
       // all points colinear
-      if(Point2D::colinear(left.getLeftEndPoint(),
+      if(point_t::colinear(left.getLeftEndPoint(),
 			   left.getRightEndPoint(),
 			   right.getRightEndPoint())) {
 	return left.getBottomEndPoint().y < right.getBottomEndPoint().y;
       }
       // only 3 colinear
-      return Point2D::leftTurn(left.getLeftEndPoint(),
+      return point_t::leftTurn(left.getLeftEndPoint(),
 			       left.getRightEndPoint(),
 			       right.getRightEndPoint());
     }
     // normal case
-    return Point2D::leftTurn(left.getLeftEndPoint(),
+    return point_t::leftTurn(left.getLeftEndPoint(),
 			     left.getRightEndPoint(),
 			     right.getLeftEndPoint());
   }
   
-  bool LineSegment::xdesc(const LineSegment& bottom, const LineSegment& top) {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::xdesc(const BasicLineSegment& bottom,
+				       const BasicLineSegment& top) {
     // both horizontal
     if(bottom.isHorizontal() && top.isHorizontal())
       return bottom.getLeftEndPoint().x > top.getLeftEndPoint().x;
@@ -236,19 +261,21 @@ namespace geometry {
     if(bottom.isHorizontal())
       return bottom.getLeftEndPoint().x > top.getBottomEndPoint().x;
     // left.left, left.right, right.left colinear
-    if(Point2D::colinear(bottom.getBottomEndPoint(),
+    if(point_t::colinear(bottom.getBottomEndPoint(),
 			 bottom.getTopEndPoint(),
 			 top.getBottomEndPoint()))
-      return Point2D::rightTurn(bottom.getBottomEndPoint(),
+      return point_t::rightTurn(bottom.getBottomEndPoint(),
 				bottom.getTopEndPoint(),
 				top.getTopEndPoint());
     // normal case
-    return Point2D::rightTurn(bottom.getBottomEndPoint(),
+    return point_t::rightTurn(bottom.getBottomEndPoint(),
 			      bottom.getTopEndPoint(),
 			      top.getBottomEndPoint());
   }
 
-  bool LineSegment::xasc(const LineSegment& bottom, const LineSegment& top) {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::xasc(const BasicLineSegment& bottom,
+				      const BasicLineSegment& top) {
     // both horizontal
     if(bottom.isHorizontal() && top.isHorizontal())
       return bottom.getLeftEndPoint().x < top.getLeftEndPoint().x;
@@ -256,51 +283,74 @@ namespace geometry {
     if(bottom.isHorizontal())
       return bottom.getLeftEndPoint().x < top.getBottomEndPoint().x;
     // left.left, left.right, right.left colinear
-    if(Point2D::colinear(bottom.getBottomEndPoint(),
+    if(point_t::colinear(bottom.getBottomEndPoint(),
 			 bottom.getTopEndPoint(),
 			 top.getBottomEndPoint()))
-      return Point2D::leftTurn(bottom.getBottomEndPoint(),
+      return point_t::leftTurn(bottom.getBottomEndPoint(),
 			       bottom.getTopEndPoint(),
 			       top.getTopEndPoint());
     // normal case
-    return Point2D::leftTurn(bottom.getBottomEndPoint(),
+    return point_t::leftTurn(bottom.getBottomEndPoint(),
 			     bottom.getTopEndPoint(),
 			     top.getBottomEndPoint());
   }
 
-  ostream& operator<<(ostream& os, const LineSegment& ls) {
+  template <class Kernel>
+  ostream& operator<<(ostream& os, const BasicLineSegment<Kernel>& ls) {
     return os << ls.getFirstEndPoint() << " " << ls.getSecondEndPoint();
   }
   
-  istream& operator>>(istream& is, LineSegment& ls) {
-    is >> ls.first >> ls.second;
-    ls.build();
+  template <class Kernel>
+  istream& operator>>(istream& is, BasicLineSegment<Kernel>& ls) {
+    typename BasicLineSegment<Kernel>::point_t first, second;
+    is >> first >> second;
+    ls.build(first,second);
     return is;
   }
 
-  void LineSegment::build(void) {
+  // stores the end points ordered by x, remembering which one was given
+  // first and which one is lower so the other views can be derived, and
+  // whether the segment is vertical or horizontal, which the comparisons
+  // ask often
+  template <class Kernel>
+  void BasicLineSegment<Kernel>::build(const point_t& first,
+				       const point_t& second) {
+    flags = 0;
     if(first.x < second.x) {
       left = first;
       right = second;
     } else {
       left = second;
       right = first;
+      flags |= FIRST_IS_RIGHT;
     }
-    if(first.y < second.y) {
-      bottom = first;
-      top = second;
-    } else {
-      bottom = second;
-      top = first;
-    }
+    // the lower end point is the first one when first.y < second.y
+    if((first.y < second.y) == ((flags & FIRST_IS_RIGHT) != 0))
+      flags |= BOTTOM_IS_RIGHT;
+    if(left.x == right.x)
+      flags |= VERTICAL;
+    if(left.y == right.y)
+      flags |= HORIZONTAL;
   }
 
-  bool LineSegment::operator==(const LineSegment& other) const {
-    return ((first == other.first) && (second == other.second))
-      || ((first == other.second) && (second == other.first));
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::operator==(const BasicLineSegment& other) const {
+    return ((left == other.left) && (right == other.right))
+      || ((left == other.right) && (right == other.left));
   }
 
-  bool LineSegment::operator!=(const LineSegment& other) const {
+  template <class Kernel>
+  bool BasicLineSegment<Kernel>::operator!=(const BasicLineSegment& other) const {
     return !((*this) == other);
   }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_LINESEGMENT(K)					\
+  template class BasicLineSegment<K>;					\
+  template ostream& operator<<(ostream&, const BasicLineSegment<K>&);	\
+  template istream& operator>>(istream&, BasicLineSegment<K>&);
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_LINESEGMENT)
 }
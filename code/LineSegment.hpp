@@ -11,7 +11,9 @@
 // PURPOSE: Stores the information associated with a line segment in         //
 //          R2.  In other words, a pair of end points of the line segment.   //
 //                                                                           //
-// NOTES:   None.                                                            //
+// NOTES:   BasicLineSegment is parameterized by a geometry kernel (see      //
+//          Kernel.hpp); LineSegment is the segment of the default kernel.   //
+//          intersection() throws with a kernel that is not a field.         //
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 // Public Variable:                     Description:                         //
@@ -27,60 +29,81 @@
 
 namespace geometry {
 
-  struct IntersectionResult {
+  template <class Kernel>
+  struct BasicIntersectionResult {
     bool isParallel;
     bool isCoincident;
     bool isIntersecting;
-    Point2D point;
-    IntersectionResult() :
+    BasicPoint2D<Kernel> point;
+    BasicIntersectionResult() :
       isParallel(false),
       isCoincident(false),
       isIntersecting(false)
     {}
   };
   
-  class LineSegment {
+  template <class Kernel>
+  class BasicLineSegment {
   public:
-    friend istream& operator>>(istream&,LineSegment&);
-    LineSegment(int ax=0, int ay=0, int bx=0, int by=0);
-    LineSegment(Point2D&,Point2D&);
-    LineSegment(const Point2D&,const Point2D&);
-    ~LineSegment();
+    typedef Kernel kernel_t;
+    typedef typename Kernel::coord_t coord_t;
+    typedef BasicPoint2D<Kernel> point_t;
 
-    const Point2D& getFirstEndPoint() const;
-    const Point2D& getSecondEndPoint() const;
+    template <class K>
+    friend istream& operator>>(istream&,BasicLineSegment<K>&);
+    BasicLineSegment(int ax=0, int ay=0, int bx=0, int by=0);
+    BasicLineSegment(point_t&,point_t&);
+    BasicLineSegment(const point_t&,const point_t&);
+    ~BasicLineSegment();
 
-    const Point2D& getLeftEndPoint() const;
-    const Point2D& getRightEndPoint() const;
-    const Point2D& getTopEndPoint() const;
-    const Point2D& getBottomEndPoint() const;
+    const point_t& getFirstEndPoint() const;
+    const point_t& getSecondEndPoint() const;
+
+    const point_t& getLeftEndPoint() const;
+    const point_t& getRightEndPoint() const;
+    const point_t& getTopEndPoint() const;
+    const point_t& getBottomEndPoint() const;
 
     const bool isVertical() const;
     const bool isHorizontal() const;
     
-    IntersectionResult intersection(const LineSegment&) const;
+    BasicIntersectionResult<Kernel> intersection(const BasicLineSegment&) const;
 
-    bool operator<(const LineSegment&) const;
-    bool operator>(const LineSegment&) const;
-    bool operator<=(const LineSegment&) const;
-    bool operator>=(const LineSegment&) const;
+    bool operator<(const BasicLineSegment&) const;
+    bool operator>(const BasicLineSegment&) const;
+    bool operator<=(const BasicLineSegment&) const;
+    bool operator>=(const BasicLineSegment&) const;
 
-    static bool ydesc(const LineSegment&,const LineSegment&);
-    static bool yasc(const LineSegment&,const LineSegment&);
-    static bool xdesc(const LineSegment&,const LineSegment&);
-    static bool xasc(const LineSegment&,const LineSegment&);
+    static bool ydesc(const BasicLineSegment&,const BasicLineSegment&);
+    static bool yasc(const BasicLineSegment&,const BasicLineSegment&);
+    static bool xdesc(const BasicLineSegment&,const BasicLineSegment&);
+    static bool xasc(const BasicLineSegment&,const BasicLineSegment&);
 
-    bool operator==(const LineSegment&) const;
-    bool operator!=(const LineSegment&) const;
+    bool operator==(const BasicLineSegment&) const;
+    bool operator!=(const BasicLineSegment&) const;
 
   private:
-    Point2D first, second, left, right, top, bottom;
+    // the end points ordered by x; the remaining views are derived from
+    // the flags below
+    point_t left, right;
+    unsigned char flags;
+
+    enum {
+      FIRST_IS_RIGHT  = 1,
+      BOTTOM_IS_RIGHT = 2,
+      VERTICAL        = 4,
+      HORIZONTAL      = 8
+    };
 
-    void build(void);
+    void build(const point_t&,const point_t&);
   };
 
-  ostream& operator<<(ostream&,const LineSegment&);
-    
+  template <class Kernel>
+  ostream& operator<<(ostream&,const BasicLineSegment<Kernel>&);
+
+  // The segment of the default kernel
+  typedef BasicLineSegment<DefaultKernel> LineSegment;
+  typedef BasicIntersectionResult<DefaultKernel> IntersectionResult;
 }
 
 #endif
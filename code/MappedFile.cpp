@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    MappedFile.cpp                                                   //
+//                                                                           //
+// MODULE:  Input/Output                                                     //
+//                                                                           //
+// NOTES:   An empty file is not mapped, since mmap refuses a length of 0.   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include "MappedFile.hpp"
+
+using namespace std;
+
+namespace io {
+  MappedFile::MappedFile()
+    : _data(0),
+      _size(0)
+  {
+  }
+
+  MappedFile::~MappedFile() {
+    close();
+  }
+
+  void MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path,O_RDONLY);
+    if(fd < 0)
+      throw string("Could not open ") + path;
+    struct stat status;
+    if(fstat(fd,&status) != 0) {
+      ::close(fd);
+      throw string("Could not read the size of ") + path;
+    }
+    _size = status.st_size;
+    if(_size > 0) {
+      void* data = mmap(0,_size,PROT_READ,MAP_SHARED,fd,0);
+      if(data == MAP_FAILED) {
+	::close(fd);
+	_size = 0;
+	throw string("Could not map ") + path;
+      }
+      _data = static_cast<const char*>(data);
+    }
+    // the mapping keeps the file open
+    ::close(fd);
+  }
+
+  void MappedFile::close() {
+    if(_data)
+      munmap(const_cast<char*>(_data),_size);
+    _data = 0;
+    _size = 0;
+  }
+
+  const char* MappedFile::data() const {
+    return _data;
+  }
+
+  size_t MappedFile::size() const {
+    return _size;
+  }
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    MappedFile.hpp                                                   //
+//                                                                           //
+// MODULE:  Input/Output                                                     //
+//                                                                           //
+// PURPOSE: A read-only file mapped into memory.                             //
+//                                                                           //
+// NOTES:   The mapping is shared, so processes mapping the same file share  //
+//          its pages.  The file must not change while it is mapped.         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// open(path)                           maps a file, throwing a string if    //
+//                                      it cannot                            //
+// close()                              unmaps the file                      //
+// data()                               the first byte of the file           //
+// size()                               the number of bytes in the file      //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+
+namespace io {
+
+  class MappedFile {
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    void open(const char* path);
+    void close();
+
+    const char* data() const;
+    size_t size() const;
+
+  private:
+    // not copyable, the mapping belongs to one object
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* _data;
+    size_t _size;
+  };
+}
+
+#endif
@@ -16,57 +16,70 @@
 
 namespace geometry {
   /////////////////////////////////////////////////////////////////////////////
-  // Point2D implementation                                                  //
+  // BasicPoint2D implementation                                             //
   /////////////////////////////////////////////////////////////////////////////
-  Point2D Point2D::operator-(const Point2D& other) const {
-    return Point2D(x - other.x, y - other.y);
+  template <class Kernel>
+  BasicPoint2D<Kernel>
+  BasicPoint2D<Kernel>::operator-(const BasicPoint2D& other) const {
+    return BasicPoint2D(x - other.x, y - other.y);
   }
 
-  coord_t Point2D::crossProduct(const Point2D& a, const Point2D& b) {
+  template <class Kernel>
+  typename BasicPoint2D<Kernel>::coord_t
+  BasicPoint2D<Kernel>::crossProduct(const BasicPoint2D& a,
+				     const BasicPoint2D& b) {
     return (a.x*b.y)-(b.x*a.y);
   }
 
-  bool Point2D::leftTurn(const Point2D& a, const Point2D& b, const Point2D& c) {
-    return crossProduct(c-a,b-a) < 0;
-  }
-
-  bool Point2D::rightTurn(const Point2D& a, const Point2D& b, const Point2D& c) {
-    return crossProduct(c-a,b-a) > 0;
-  }
-
-  bool Point2D::colinear(const Point2D& a, const Point2D& b, const Point2D& c) {
-    return crossProduct(c-a,b-a) == 0;
-  }
-    
-  
-  bool operator>(const Point2D& a, const Point2D& b) {
+  template <class Kernel>
+  bool operator>(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b) {
     return a.x > b.x;
   }
 
-  bool operator>=(const Point2D& a, const Point2D& b) {
+  template <class Kernel>
+  bool operator>=(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b) {
     return !(operator<(a,b));
   }
 
-  bool operator<(const Point2D& a, const Point2D& b) {
+  template <class Kernel>
+  bool operator<(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b) {
     return a.x < b.x;
   }
 
-  bool operator<=(const Point2D& a, const Point2D& b) {
+  template <class Kernel>
+  bool operator<=(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b) {
     return !(operator>(a,b));
   }
 
-  bool operator==(const Point2D& a, const Point2D& b) {
+  template <class Kernel>
+  bool operator==(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b) {
     return (a.x == b.x) && (a.y == b.y);
   }
-  
-  ostream& operator<<(ostream& os, const Point2D& p) {
+
+  template <class Kernel>
+  ostream& operator<<(ostream& os, const BasicPoint2D<Kernel>& p) {
     os << p.x << " " << p.y;
     return os;
   }
 
-  istream& operator>>(istream& is, Point2D& p) {
+  template <class Kernel>
+  istream& operator>>(istream& is, BasicPoint2D<Kernel>& p) {
     is >> p.x >> p.y;
     return is;
   }
-}
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_POINT2D(K)						\
+  template class BasicPoint2D<K>;					\
+  template bool operator> (const BasicPoint2D<K>&, const BasicPoint2D<K>&); \
+  template bool operator>=(const BasicPoint2D<K>&, const BasicPoint2D<K>&); \
+  template bool operator< (const BasicPoint2D<K>&, const BasicPoint2D<K>&); \
+  template bool operator<=(const BasicPoint2D<K>&, const BasicPoint2D<K>&); \
+  template bool operator==(const BasicPoint2D<K>&, const BasicPoint2D<K>&); \
+  template ostream& operator<<(ostream&, const BasicPoint2D<K>&);	\
+  template istream& operator>>(istream&, BasicPoint2D<K>&);
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_POINT2D)
+}
@@ -11,7 +11,8 @@
 // PURPOSE: Stores the information associated with a point in R2.  In        //
 //          other words a pair of coordinates                                //
 //                                                                           //
-// NOTES:   None.                                                            //
+// NOTES:   BasicPoint2D is parameterized by a geometry kernel (see          //
+//          Kernel.hpp); Point2D is the point of the default kernel.         //
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 // Public Variable:                     Description:                         //
@@ -29,24 +30,26 @@
 
 using namespace std;
 
-#include <LEDA/numbers/rational.h>
-
-using leda::rational;
+#include "Kernel.hpp"
 
 namespace geometry {
-  // Defines the implementation and precision of coordinates
-  typedef rational coord_t;
+  // Defines the implementation and precision of default coordinates
+  typedef DefaultKernel::coord_t coord_t;
   
   /////////////////////////////////////////////////////////////////////////////
-  // Point2D interface                                                       //
+  // BasicPoint2D interface                                                  //
   /////////////////////////////////////////////////////////////////////////////
-  class Point2D {
+  template <class Kernel>
+  class BasicPoint2D {
   public:
+    typedef Kernel kernel_t;
+    typedef typename Kernel::coord_t coord_t;
+
     coord_t x, y;
 
     ///////////////////////////////////////////////////////////////////////////
     //                                                                       //
-    // FUNCTION NAME: Point2D                                                //
+    // FUNCTION NAME: BasicPoint2D                                           //
     //                                                                       //
     // PURPOSE:       Empty constructor                                      //
     //                                                                       //
@@ -59,13 +62,13 @@ namespace geometry {
     // NOTES:         None.                                                  //
     //                                                                       //
     ///////////////////////////////////////////////////////////////////////////
-    Point2D()
+    BasicPoint2D()
       : x(0), y(0)
     {}
     
     ///////////////////////////////////////////////////////////////////////////
     //                                                                       //
-    // FUNCTION NAME: Point2D                                                //
+    // FUNCTION NAME: BasicPoint2D                                           //
     //                                                                       //
     // PURPOSE:       Basic constructor.                                     //
     //                                                                       //
@@ -81,26 +84,70 @@ namespace geometry {
     // NOTES:         None.                                                  //
     //                                                                       //
     ///////////////////////////////////////////////////////////////////////////
-    Point2D(coord_t x, coord_t y)
+    BasicPoint2D(coord_t x, coord_t y)
       : x(x), y(y)
     {}
 
-    Point2D(const Point2D& other)
+    BasicPoint2D(const BasicPoint2D& other)
       : x(other.x), y(other.y)
     {}
 
-    Point2D operator-(const Point2D& other) const;
+    BasicPoint2D operator-(const BasicPoint2D& other) const;
 
-    static coord_t crossProduct(const Point2D& a, const Point2D& b);
+    static coord_t crossProduct(const BasicPoint2D& a, const BasicPoint2D& b);
 
-    static bool leftTurn(const Point2D& a, const Point2D& b, const Point2D& c);
+    // the predicates are defined here so that the kernel's orientation
+    // test inlines into their callers
+    static bool leftTurn(const BasicPoint2D& a,
+			 const BasicPoint2D& b,
+			 const BasicPoint2D& c) {
+      return Kernel::orientation(a,b,c) > 0;
+    }
 
-    static bool rightTurn(const Point2D& a, const Point2D& b, const Point2D& c);
+    static bool rightTurn(const BasicPoint2D& a,
+			  const BasicPoint2D& b,
+			  const BasicPoint2D& c) {
+      return Kernel::orientation(a,b,c) < 0;
+    }
 
-    static bool colinear(const Point2D& a, const Point2D& b, const Point2D& c);
+    static bool colinear(const BasicPoint2D& a,
+			 const BasicPoint2D& b,
+			 const BasicPoint2D& c) {
+      return Kernel::orientation(a,b,c) == 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    //                                                                       //
+    // FUNCTION NAME: orientation                                            //
+    //                                                                       //
+    // PURPOSE:       Determines on which side of the line through a and b   //
+    //                the point c lies.                                      //
+    //                                                                       //
+    // SECURITY:      public                                                 //
+    //                                                                       //
+    // PARAMETERS                                                            //
+    //   Type/Name:   Point2D/a, Point2D/b                                   //
+    //   Description: Two points defining a directed line.                   //
+    //                                                                       //
+    //   Type/Name:   Point2D/c                                              //
+    //   Description: The point to classify.                                 //
+    //                                                                       //
+    // RETURN:        1 if a, b, c make a left turn, -1 if they make a right //
+    //                turn and 0 if they are colinear.                       //
+    //                                                                       //
+    // NOTES:         Delegates to the kernel; the rational kernel first     //
+    //                evaluates the determinant in double precision with an  //
+    //                error bound.  See PredicateStatistics.                 //
+    //                                                                       //
+    ///////////////////////////////////////////////////////////////////////////
+    static int orientation(const BasicPoint2D& a,
+			   const BasicPoint2D& b,
+			   const BasicPoint2D& c) {
+      return Kernel::orientation(a,b,c);
+    }
     
     struct yxasc {
-      bool operator()(const Point2D& a, const Point2D& b) const {
+      bool operator()(const BasicPoint2D& a, const BasicPoint2D& b) const {
 	if(a.y == b.y)
 	  return a.x < b.x;
 	return a.y < b.y;
@@ -108,7 +155,7 @@ namespace geometry {
     };
 
     struct yxdesc {
-      bool operator()(const Point2D& a, const Point2D& b) const {
+      bool operator()(const BasicPoint2D& a, const BasicPoint2D& b) const {
 	if(a.y == b.y)
 	  return a.x > b.x;
 	return a.y > b.y;
@@ -125,10 +172,10 @@ namespace geometry {
   // SECURITY:      public                                                   //
   //                                                                         //
   // PARAMETERS                                                              //
-  //   Type/Name:   Point2D/a                                                //
+  //   Type/Name:   BasicPoint2D/a                                           //
   //   Description: The first point to compare.                              //
   //                                                                         //
-  //   Type/Name:   Point2D/b                                                //
+  //   Type/Name:   BasicPoint2D/b                                           //
   //   Description: The second point to compare.                             //
   //                                                                         //
   // RETURN:        True if a is greater than b, false otherwise.            //
@@ -136,8 +183,10 @@ namespace geometry {
   // NOTES:         None.                                                    //
   //                                                                         //
   /////////////////////////////////////////////////////////////////////////////
-  bool operator>(const Point2D& a, const Point2D& b);
-  bool operator>=(const Point2D& a, const Point2D& b);
+  template <class Kernel>
+  bool operator>(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b);
+  template <class Kernel>
+  bool operator>=(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b);
 
   /////////////////////////////////////////////////////////////////////////////
   //                                                                         //
@@ -148,10 +197,10 @@ namespace geometry {
   // SECURITY:      public                                                   //
   //                                                                         //
   // PARAMETERS                                                              //
-  //   Type/Name:   Point2D/a                                                //
+  //   Type/Name:   BasicPoint2D/a                                           //
   //   Description: The first point to compare.                              //
   //                                                                         //
-  //   Type/Name:   Point2D/b                                                //
+  //   Type/Name:   BasicPoint2D/b                                           //
   //   Description: The second point to compare.                             //
   //                                                                         //
   // RETURN:        True if a is less than b, false otherwise.               //
@@ -159,10 +208,13 @@ namespace geometry {
   // NOTES:         None.                                                    //
   //                                                                         //
   /////////////////////////////////////////////////////////////////////////////
-  bool operator<(const Point2D& a, const Point2D& b);
-  bool operator<=(const Point2D& a, const Point2D& b);
+  template <class Kernel>
+  bool operator<(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b);
+  template <class Kernel>
+  bool operator<=(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b);
 
-  bool operator==(const Point2D& a, const Point2D& b);
+  template <class Kernel>
+  bool operator==(const BasicPoint2D<Kernel>& a, const BasicPoint2D<Kernel>& b);
 
   /////////////////////////////////////////////////////////////////////////////
   //                                                                         //
@@ -186,7 +238,8 @@ namespace geometry {
   // NOTES:         None.                                                    //
   //                                                                         //
   /////////////////////////////////////////////////////////////////////////////
-  ostream& operator<<(ostream& os, const Point2D& p);
+  template <class Kernel>
+  ostream& operator<<(ostream& os, const BasicPoint2D<Kernel>& p);
 
   /////////////////////////////////////////////////////////////////////////////
   //                                                                         //
@@ -208,20 +261,24 @@ namespace geometry {
   // NOTES:         None.                                                    //
   //                                                                         //
   /////////////////////////////////////////////////////////////////////////////
-  istream& operator>>(istream& os, Point2D& p);
+  template <class Kernel>
+  istream& operator>>(istream& os, BasicPoint2D<Kernel>& p);
+
+  // The point of the default kernel
+  typedef BasicPoint2D<DefaultKernel> Point2D;
 }
 namespace std {
   /////////////////////////////////////////////////////////////////////////////
   // Numeric Limits Interface                                                //
   /////////////////////////////////////////////////////////////////////////////
-  template <>
-  class numeric_limits<geometry::Point2D> {
+  template <class Kernel>
+  class numeric_limits< geometry::BasicPoint2D<Kernel> > {
     static const bool is_specialized = true;
     static const bool has_infinity =
-      numeric_limits<geometry::coord_t>::has_infinity;
-    static geometry::Point2D infinity();
-    static geometry::Point2D max();
-    static geometry::Point2D min();
+      numeric_limits<typename Kernel::coord_t>::has_infinity;
+    static geometry::BasicPoint2D<Kernel> infinity();
+    static geometry::BasicPoint2D<Kernel> max();
+    static geometry::BasicPoint2D<Kernel> min();
   };
 }
 #endif
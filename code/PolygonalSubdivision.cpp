@@ -10,18 +10,224 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sched.h>
 #include "PolygonalSubdivision.hpp"
+#include "SegmentReader.hpp"
+#include "SlabOrder.hpp"
+#include "Trace.hpp"
 #include <iostream>
 #include <sstream>
 
 namespace geometry {
 
-  PolygonalSubdivision::PolygonalSubdivision()
+  // The added segments and the faces of the sides of an updated
+  // subdivision are kept in pages of this many, so that an update
+  // copies only the pages it changes, and the versions share the rest.
+  const unsigned int UPDATE_PAGE = 1024;
+
+  // Once the removed segments make up more than one in this many of the
+  // entries of the indexes of an updated subdivision, the present ones
+  // are indexed again together, so that the queries pass over few.
+  const unsigned int COMPACT_FRACTION = 4;
+
+  // orders segments by their end points, the left and right ones, or the
+  // bottom and top ones of a vertical segment, to find them by value
+  template <class Segment>
+  class EndPointOrder {
+  public:
+    typedef typename Segment::point_t point_t;
+
+    bool operator()(const Segment& a, const Segment& b) const {
+      if(less(first(a),first(b)))
+	return true;
+      if(less(first(b),first(a)))
+	return false;
+      return less(second(a),second(b));
+    }
+
+  private:
+    static const point_t& first(const Segment& s) {
+      return s.isVertical() ? s.getBottomEndPoint() : s.getLeftEndPoint();
+    }
+
+    static const point_t& second(const Segment& s) {
+      return s.isVertical() ? s.getTopEndPoint() : s.getRightEndPoint();
+    }
+
+    static bool less(const point_t& a, const point_t& b) {
+      return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+  };
+
+  // What the queries of an updated subdivision read.  An update makes a
+  // new version, sharing the unchanged pages and indexes of the last,
+  // which is freed once no query can still read it.  A segment is
+  // present while its sides have faces, and removed ones are NONE.
+  template <class Kernel>
+  struct BasicPolygonalSubdivision<Kernel>::Version {
+    // the indexes of the added segments, the largest first, and, once
+    // the index made by freeze() is no longer searched, of the present
+    // segments it held
+    vector<Level*> levels;
+    // whether the index made by freeze() is searched
+    bool own_index;
+    // the segments removed so far, from any index
+    unsigned int removed_count;
+    // the faces of the sides, by page; those no update has written lie
+    // in _faces
+    vector<const unsigned int*> faces;
+    // the added segments, by page, from handle _segment_count on
+    vector<const segment_t*> added;
+    unsigned int handle_count;
+    unsigned int face_count;
+
+    Version()
+      : own_index(true),
+	removed_count(0),
+	handle_count(0),
+	face_count(0)
+    {}
+
+    unsigned int face(unsigned int side) const {
+      return faces[side / UPDATE_PAGE][side % UPDATE_PAGE];
+    }
+
+    bool present(unsigned int handle) const {
+      return face(2 * handle) != NONE;
+    }
+
+    // The page holding side, copied first if it is still that of the
+    // version this one was made from.  The sides past those of that
+    // version are NONE.
+    unsigned int* writable(const Version& from, unsigned int side) {
+      unsigned int page = side / UPDATE_PAGE;
+      while(faces.size() <= page) {
+	unsigned int* fresh = new unsigned int[UPDATE_PAGE];
+	fill(fresh,fresh + UPDATE_PAGE,static_cast<unsigned int>(NONE));
+	faces.push_back(fresh);
+      }
+      if(page < from.faces.size() && faces[page] == from.faces[page]) {
+	unsigned int valid = 2 * from.handle_count - page * UPDATE_PAGE;
+	if(valid > UPDATE_PAGE)
+	  valid = UPDATE_PAGE;
+	unsigned int* copied = new unsigned int[UPDATE_PAGE];
+	copy(from.faces[page],from.faces[page] + valid,copied);
+	fill(copied + valid,copied + UPDATE_PAGE,
+	     static_cast<unsigned int>(NONE));
+	faces[page] = copied;
+      }
+      return const_cast<unsigned int*>(faces[page]) + side % UPDATE_PAGE;
+    }
+  };
+
+  // The added segments of a version are indexed together, as a
+  // subdivision of their own, locked and frozen.
+  template <class Kernel>
+  struct BasicPolygonalSubdivision<Kernel>::Level {
+    BasicPolygonalSubdivision<Kernel> index;
+    // the handle in the updated subdivision of each segment of the index
+    vector<unsigned int> handles;
+  };
+
+  // What only update() reads: the pages the added segments are written
+  // to, the sides of each face as lists threaded through the sides, and
+  // the handles of the present added segments.
+  template <class Kernel>
+  struct BasicPolygonalSubdivision<Kernel>::UpdateState {
+    vector<segment_t*> segment_pages;
+    vector<unsigned int> face_first;
+    vector<unsigned int> side_next;
+    map<segment_t, unsigned int, EndPointOrder<segment_t> > added;
+  };
+
+  // Counts a query in under the present epoch while it reads the version
+  // it found.
+  template <class Kernel>
+  class BasicPolygonalSubdivision<Kernel>::VersionReader {
+  public:
+    VersionReader(const BasicPolygonalSubdivision<Kernel>& subdivision)
+      : _count(subdivision._readers[subdivision._epoch & 1].count) {
+      __sync_fetch_and_add(&_count,1);
+      version = subdivision._version;
+    }
+
+    ~VersionReader() {
+      __sync_fetch_and_sub(&_count,1);
+    }
+
+    const Version* version;
+
+  private:
+    volatile unsigned long& _count;
+  };
+
+  // The present segments nearest a query, above and below it, over the
+  // subdivision's own index and those of the added segments, and the
+  // vertical one through it.
+  template <class Kernel>
+  struct BasicPolygonalSubdivision<Kernel>::Nearest {
+    unsigned int above;
+    unsigned int below;
+    unsigned int vertical;
+    const segment_t* a;
+    const segment_t* b;
+    bool on_sweep_line;
+
+    Nearest()
+      : above(NONE),
+	below(NONE),
+	vertical(NONE),
+	a(0),
+	b(0),
+	on_sweep_line(false)
+    {}
+
+    // the lower of the segments above
+    void offer_above(unsigned int handle, const segment_t& s) {
+      if(a == 0 || BasicSlabOrder<Kernel>::less(*a,s)) {
+	above = handle;
+	a = &s;
+      }
+    }
+
+    // the higher of the segments below
+    void offer_below(unsigned int handle, const segment_t& s) {
+      if(b == 0 || BasicSlabOrder<Kernel>::less(s,*b)) {
+	below = handle;
+	b = &s;
+      }
+    }
+  };
+
+  template <class Kernel>
+  BasicPolygonalSubdivision<Kernel>::BasicPolygonalSubdivision(Engine engine)
     : line_segments_left(),
-      line_segments_right(),
-      x_coords(),
+      segment_table(),
+      _segments(0),
+      _segment_count(0),
+      _non_vertical(0),
+      _rectilinear(false),
+      face_table(),
+      _faces(0),
+      _face_count(0),
       sweep_points(),
-      psl(),
+      slab_directory(),
+      slab_sizes(),
+      band_starts(),
+      bands(),
+      slab_index(),
+      snapshot(),
+      _arena(),
+      trapezoidal_map(_arena),
+      triangulation_hierarchy(),
+      _version(0),
+      _updates(0),
+      _epoch(0),
+      _engine(engine),
       _locked(false),
 #ifdef NDEBUG
       _log(clog,"/dev/null") // unportable hack
@@ -29,40 +235,568 @@ namespace geometry {
       _log(clog,"log_PS.txt")
 #endif
   {
+    _readers[0].count = 0;
+    _readers[1].count = 0;
   }
 
-  PolygonalSubdivision::~PolygonalSubdivision() {
+  template <class Kernel>
+  BasicPolygonalSubdivision<Kernel>::~BasicPolygonalSubdivision() {
+    for(unsigned int i = 0; i < bands.size(); ++i)
+      delete bands[i];
+    if(_version != 0)
+      release(_version,Version());
+    if(_updates != 0) {
+      for(unsigned int i = 0; i < _updates->segment_pages.size(); ++i)
+	delete[] _updates->segment_pages[i];
+      delete _updates;
+    }
+  }
+
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::Engine
+  BasicPolygonalSubdivision<Kernel>::engine() const {
+    return _engine;
   }
 
-  void PolygonalSubdivision::addLineSegment(LineSegment& ls) {
+  template <class Kernel>
+  bool BasicPolygonalSubdivision<Kernel>::supports(Engine engine) {
+    return engine != TRIANGULATION_HIERARCHY ||
+      (Kernel::is_field && Kernel::is_exact);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::addLineSegment(segment_t& ls) {
+    check_unlocked();
     line_segments_left.push_back(ls);
-    x_coords.insert(ls.getFirstEndPoint().x);
-    x_coords.insert(ls.getSecondEndPoint().x);
-    // we don't need to sweep at line intersections because a
-    // polygonal subdivision won't have intersections
   }
 
-  void PolygonalSubdivision::addLineSegment(const LineSegment& ls) {
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::addLineSegment(const segment_t& ls) {
+    check_unlocked();
     line_segments_left.push_back(ls);
-    x_coords.insert(ls.getFirstEndPoint().x);
-    x_coords.insert(ls.getSecondEndPoint().x);
-    // we don't need to sweep at line intersections because a
-    // polygonal subdivision won't have intersections
   }
 
-  bool leftDescX(const LineSegment& a, const LineSegment& b) {
-    return a.getLeftEndPoint().x > b.getLeftEndPoint().x;
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::addLineSegments(const segment_t* begin,
+						     const segment_t* end) {
+    check_unlocked();
+    line_segments_left.insert(line_segments_left.end(),begin,end);
+  }
+
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::addLineSegments(vector<segment_t>&
+						     segments) {
+    check_unlocked();
+    if(line_segments_left.empty()) {
+      line_segments_left.swap(segments);
+    } else {
+      line_segments_left.insert(line_segments_left.end(),
+				segments.begin(),segments.end());
+    }
+    vector<segment_t>().swap(segments);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::addLineSegments(const char* path) {
+    check_unlocked();
+    BasicSegmentReader<Kernel>::read(path,line_segments_left);
   }
 
-  bool rightDescX(const LineSegment& a, const LineSegment& b) {
-    return a.getRightEndPoint().x > b.getRightEndPoint().x;
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::addLineSegments(const char* path,
+						     concurrency::ThreadPool&
+						     pool) {
+    check_unlocked();
+    BasicSegmentReader<Kernel>::read(path,line_segments_left,&pool);
   }
 
-  void PolygonalSubdivision::lock() {
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::check_unlocked() const {
     if(_locked)
-      return;
+      throw "PolygonalSubdivision is locked; update() changes it";
+  }
 
-    clog << "There are " << line_segments_left.size() << " segments." << endl;
+  // for lower_bound of a point over the vertical segments, sorted by x
+  // and then by lower end point
+  template <class Segment>
+  class BottomBefore {
+  public:
+    typedef typename Segment::point_t point_t;
+
+    bool operator()(const Segment& s, const point_t& p) const {
+      const point_t& bottom = s.getBottomEndPoint();
+      return bottom.x < p.x || (bottom.x == p.x && bottom.y < p.y);
+    }
+  };
+
+  // for lower_bound of a point over the non-vertical segments, sorted by
+  // the x of their left end points
+  template <class Segment>
+  class LeftBefore {
+  public:
+    typedef typename Segment::point_t point_t;
+
+    bool operator()(const Segment& s, const point_t& p) const {
+      return s.getLeftEndPoint().x < p.x;
+    }
+  };
+
+  // orders the vertical events at one x by the lower end points of their
+  // segments, then as they were added
+  template <class Segment, class Event>
+  class VerticalBelow {
+  public:
+    VerticalBelow(const Segment* segments) : _segments(segments) {}
+
+    bool operator()(const Event& a, const Event& b) const {
+      const typename Segment::point_t& pa =
+	_segments[a.segment].getBottomEndPoint();
+      const typename Segment::point_t& pb =
+	_segments[b.segment].getBottomEndPoint();
+      return pa.y < pb.y || (!(pb.y < pa.y) && a.segment < b.segment);
+    }
+
+  private:
+    const Segment* _segments;
+  };
+
+  // for upper_bound of a query point over handles in the order of a slab
+  template <class Segment>
+  class KeyBefore {
+  public:
+    KeyBefore(const Segment* segments) : _segments(segments) {}
+
+    bool operator()(const typename Segment::point_t& p,
+		    unsigned int s) const {
+      return BasicSlabOrder<typename Segment::kernel_t>::less(p,
+							     _segments[s]);
+    }
+
+  private:
+    const Segment* _segments;
+  };
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::lock() {
+    build(1,0);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::lock(concurrency::ThreadPool& pool) {
+    build(pool.size(),&pool);
+  }
+
+  // builds the bands of a subdivision, one per worker
+  template <class Kernel>
+  class BandBuildTask : public concurrency::ThreadPool::Task {
+  public:
+    typedef BasicPolygonalSubdivision<Kernel> subdivision_t;
+
+    typedef typename subdivision_t::SweepEvent event_t;
+
+    BandBuildTask(subdivision_t& subdivision, const vector<event_t>& events)
+      : _subdivision(subdivision),
+	_events(events)
+    {}
+
+    // what a band throws, of whatever type, the pool throws again on
+    // the thread which called lock()
+    void run(unsigned int worker) {
+      if(worker < _subdivision.bands.size())
+	_subdivision.build_band(worker,_events);
+    }
+
+  private:
+    subdivision_t& _subdivision;
+    const vector<event_t>& _events;
+  };
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Sorts the events of the added segments once, and makes everything
+  // else in a single pass over them: the sweep points are their distinct
+  // x coordinates, and the segments are given their handles in the order
+  // they are inserted, the vertical ones after the rest, from the bottom
+  // on each line.  The added segments are then permuted in place into
+  // the table.
+  ///////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::sort_events(vector<SweepEvent>&
+						      events) {
+    TRACE(TRACE_SWEEP,TRACE_INFO,
+	  "There are " << line_segments_left.size() << " segments.");
+
+    unsigned int count = line_segments_left.size();
+    unsigned int non_vertical = 0;
+    bool rectilinear = true;
+    events.clear();
+    events.reserve(2 * count);
+    for(unsigned int i = 0; i < count; ++i) {
+      const segment_t& line = line_segments_left[i];
+      if(line.isVertical()) {
+	events.push_back(SweepEvent(line.getLeftEndPoint().x,
+				    SweepEvent::VERTICAL,
+				    i));
+      } else {
+	events.push_back(SweepEvent(line.getLeftEndPoint().x,
+				    SweepEvent::INSERT,
+				    i));
+	events.push_back(SweepEvent(line.getRightEndPoint().x,
+				    SweepEvent::REMOVE,
+				    i));
+	++non_vertical;
+	if(!line.isHorizontal())
+	  rectilinear = false;
+      }
+    }
+    sort(events.begin(),events.end());
+
+    // the vertical events come last at each x
+    for(unsigned int i = 0; i < events.size(); ) {
+      unsigned int j = i + 1;
+      if(events[i].kind == SweepEvent::VERTICAL)
+	while(j < events.size() && !(events[i].x < events[j].x))
+	  ++j;
+      if(j - i > 1)
+	sort(events.begin() + i,
+	     events.begin() + j,
+	     VerticalBelow<segment_t,SweepEvent>(&line_segments_left[0]));
+      i = j;
+    }
+
+    // The sweep points are the distinct x coordinates of the end
+    // points.  We don't need to sweep at line intersections because a
+    // polygonal subdivision won't have intersections.  A segment is
+    // inserted before it is removed, so its handle is known by then.
+    vector<unsigned int> handles(count);
+    unsigned int next_insert = 0;
+    unsigned int next_vertical = non_vertical;
+    sweep_points.clear();
+    for(typename vector<SweepEvent>::iterator event = events.begin();
+	event != events.end();
+	++event) {
+      if(sweep_points.empty() || sweep_points.back() < event->x)
+	sweep_points.push_back(event->x);
+      if(event->kind == SweepEvent::INSERT)
+	handles[event->segment] = next_insert++;
+      else if(event->kind == SweepEvent::VERTICAL)
+	handles[event->segment] = next_vertical++;
+      event->segment = handles[event->segment];
+    }
+    vector<coord_t>(sweep_points).swap(sweep_points);
+
+    // the added segments become the table, following the cycles of the
+    // permutation rather than copying them
+    for(unsigned int i = 0; i < count; ++i) {
+      while(handles[i] != i) {
+	unsigned int j = handles[i];
+	swap(line_segments_left[i],line_segments_left[j]);
+	swap(handles[i],handles[j]);
+      }
+    }
+    segment_table.swap(line_segments_left);
+    vector<segment_t>().swap(line_segments_left);
+    use_table(segment_table.empty() ? 0 : &segment_table[0],
+	      count,
+	      count - non_vertical,
+	      rectilinear);
+  }
+
+  // Disjoint sets of small integers, each named by its least member.
+  class DisjointSets {
+  public:
+    DisjointSets(unsigned int count) : _parent(count) {
+      for(unsigned int i = 0; i < count; ++i)
+	_parent[i] = i;
+    }
+
+    unsigned int find(unsigned int member) {
+      while(_parent[member] != member) {
+	_parent[member] = _parent[_parent[member]];
+	member = _parent[member];
+      }
+      return member;
+    }
+
+    void join(unsigned int a, unsigned int b) {
+      a = find(a);
+      b = find(b);
+      if(a < b)
+	_parent[b] = a;
+      else
+	_parent[a] = b;
+    }
+
+  private:
+    vector<unsigned int> _parent;
+  };
+
+  // an end of a segment, from which the segment leaves its vertex, with
+  // a copy of the vertex so that sorting by it stays in the array
+  template <class Coord>
+  struct SegmentEnd {
+    Coord x;
+    Coord y;
+    unsigned int segment;
+    bool right;
+
+    bool operator<(const SegmentEnd& other) const {
+      return x < other.x || (x == other.x && y < other.y);
+    }
+
+    bool at(const SegmentEnd& other) const {
+      return x == other.x && y == other.y;
+    }
+  };
+
+  // orders the ends at one vertex counterclockwise from the direction of
+  // positive x
+  template <class Segment>
+  class AroundVertex {
+  public:
+    typedef typename Segment::point_t point_t;
+    typedef SegmentEnd<typename point_t::coord_t> end_t;
+
+    AroundVertex(const Segment* segments) : _segments(segments) {}
+
+    const point_t& vertex(const end_t& end) const {
+      const Segment& s = _segments[end.segment];
+      return end.right ? s.getRightEndPoint() : s.getLeftEndPoint();
+    }
+
+    const point_t& away(const end_t& end) const {
+      const Segment& s = _segments[end.segment];
+      return end.right ? s.getLeftEndPoint() : s.getRightEndPoint();
+    }
+
+    bool operator()(const end_t& a, const end_t& b) const {
+      const point_t& v = vertex(a);
+      const point_t& pa = away(a);
+      const point_t& pb = away(b);
+      // the directions in [0,pi) come first
+      bool upper_a = v.y < pa.y || (v.y == pa.y && v.x < pa.x);
+      bool upper_b = v.y < pb.y || (v.y == pb.y && v.x < pb.x);
+      if(upper_a != upper_b)
+	return upper_a;
+      int side = point_t::orientation(v,pa,pb);
+      if(side != 0)
+	return side > 0;
+      return a.segment < b.segment;
+    }
+
+  private:
+    const Segment* _segments;
+  };
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Each segment has two sides, 2h above it and 2h + 1 below, or left and
+  // right of a vertical one, and 2n is the unbounded face.  The sides
+  // which bound the same face are joined in two ways:
+  //
+  // Around each vertex, the segments are taken counterclockwise, and the
+  // wedge between two in turn is one face.  This follows the boundary of
+  // each face within a connected component of the segments, as the next
+  // pointers of a half edge structure would.
+  //
+  // A face has one such boundary for each component it touches, which
+  // are joined by shooting a ray from the leftmost vertex of each
+  // component: down from below its lowest segment leaving there, or, if
+  // only a vertical segment leaves there, down from just right of it,
+  // since none of the component lies below that vertex.  The segment the
+  // ray meets is in another component, and the face just above it is
+  // the one the component lies in, or it is unbounded if the ray meets
+  // none.  With one component, no ray meets anything, and the rays of
+  // several are shot in one sweep.
+  ///////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::label_faces(const vector<SweepEvent>&
+						 events) {
+    typedef SegmentEnd<coord_t> end_t;
+    const unsigned int outer = 2 * _segment_count;
+    DisjointSets sides(outer + 1);
+    DisjointSets components(_segment_count);
+
+    // both ends of every segment, by vertex
+    vector<end_t> ends(2 * _segment_count);
+    for(unsigned int i = 0; i < ends.size(); ++i) {
+      const segment_t& s = _segments[i / 2];
+      ends[i].right = i % 2 != 0;
+      const point_t& p = ends[i].right ?
+	s.getRightEndPoint() : s.getLeftEndPoint();
+      ends[i].x = p.x;
+      ends[i].y = p.y;
+      ends[i].segment = i / 2;
+    }
+    sort(ends.begin(),ends.end());
+
+    AroundVertex<segment_t> around(_segments);
+    for(unsigned int first = 0; first < ends.size(); ) {
+      unsigned int last = first + 1;
+      while(last < ends.size() && ends[last].at(ends[first]))
+	++last;
+      sort(ends.begin() + first,ends.begin() + last,around);
+      for(unsigned int i = first; i < last; ++i) {
+	const end_t& from = ends[i];
+	const end_t& to = ends[i + 1 < last ? i + 1 : first];
+	components.join(from.segment,to.segment);
+	// left of one segment leaving the vertex, and right of the next
+	const segment_t& a = _segments[from.segment];
+	const segment_t& b = _segments[to.segment];
+	bool a_down = a.getRightEndPoint().y < a.getLeftEndPoint().y;
+	bool b_down = b.getRightEndPoint().y < b.getLeftEndPoint().y;
+	unsigned int a_left = 2 * from.segment +
+	  ((a.isVertical() && a_down) != from.right ? 1 : 0);
+	unsigned int b_right = 2 * to.segment +
+	  ((b.isVertical() && b_down) != to.right ? 0 : 1);
+	sides.join(a_left,b_right);
+      }
+      first = last;
+    }
+
+    // The ray of each component, from its first vertex in the order of
+    // the ends, which leaves its lowest segment there, or the vertical
+    // one, whose side facing the ray is below or right of it.
+    vector<end_t> rays;
+    vector<bool> shot(_segment_count,false);
+    for(unsigned int first = 0; first < ends.size(); ) {
+      unsigned int last = first + 1;
+      while(last < ends.size() && ends[last].at(ends[first]))
+	++last;
+      unsigned int component = components.find(ends[first].segment);
+      if(!shot[component]) {
+	shot[component] = true;
+	const point_t& v = around.vertex(ends[first]);
+	unsigned int lowest = first;
+	for(unsigned int i = first + 1; i < last; ++i)
+	  if(ends[lowest].segment >= _non_vertical ||
+	     (ends[i].segment < _non_vertical &&
+	      point_t::orientation(v,around.away(ends[lowest]),
+				   around.away(ends[i])) < 0))
+	    lowest = i;
+	rays.push_back(ends[lowest]);
+      }
+      first = last;
+    }
+    vector<end_t>().swap(ends);
+
+    if(rays.size() == 1) {
+      sides.join(2 * rays[0].segment + 1,outer);
+    } else {
+      typedef typename multiset<handle_t>::iterator present_t;
+      typename handle_t::Scope scope(_segments);
+      multiset<handle_t> present;
+      unsigned int next_ray = 0;
+      for(unsigned int next = 0;
+	  next < events.size() && next_ray < rays.size(); ) {
+	const coord_t& x = events[next].x;
+	for(; next < events.size() && !(x < events[next].x); ++next) {
+	  handle_t line(events[next].segment);
+	  if(events[next].kind == SweepEvent::REMOVE)
+	    present.erase(present.find(line));
+	  else if(events[next].kind == SweepEvent::INSERT)
+	    present.insert(line);
+	}
+
+	for(; next_ray < rays.size() && !(x < rays[next_ray].x); ++next_ray) {
+	  unsigned int s = rays[next_ray].segment;
+	  if(s < _non_vertical) {
+	    present_t below = present.find(handle_t(s));
+	    ++below;
+	    sides.join(2 * s + 1,
+		       below != present.end() ? 2 * (*below).index : outer);
+	  } else {
+	    // no other segment passes through the vertex, so the one
+	    // below it is strictly below; above it, the ray could meet the
+	    // component itself
+	    typename handle_t::Scope key_scope(_segments,
+					       &around.vertex(rays[next_ray]));
+	    present_t below = present.upper_bound(handle_t(handle_t::KEY));
+	    sides.join(2 * s + 1,
+		       below != present.end() ? 2 * (*below).index : outer);
+	  }
+	}
+      }
+    }
+
+    // the IDs, in the order of the sides, after the unbounded face
+    vector<unsigned int> ids(outer + 1,NONE);
+    ids[sides.find(outer)] = OUTER_FACE;
+    _face_count = 1;
+    face_table.resize(outer);
+    for(unsigned int i = 0; i < outer; ++i) {
+      unsigned int set = sides.find(i);
+      if(ids[set] == NONE)
+	ids[set] = _face_count++;
+      face_table[i] = ids[set];
+    }
+    _faces = face_table.empty() ? 0 : &face_table[0];
+
+    TRACE(TRACE_SWEEP,TRACE_INFO,
+	  "There are " << _face_count << " faces.");
+  }
+
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::use_table(const segment_t* segments,
+					       unsigned int count,
+					       unsigned int verticals,
+					       bool rectilinear) {
+    _segments = segments;
+    _segment_count = count;
+    _non_vertical = count - verticals;
+    _rectilinear = rectilinear;
+  }
+
+  template <class Kernel>
+  const typename BasicPolygonalSubdivision<Kernel>::segment_t&
+  BasicPolygonalSubdivision<Kernel>::segment(unsigned int handle) const {
+    if(handle == NONE)
+      return handle_t::none();
+    if(handle < _segment_count || !updated())
+      return _segments[handle];
+    VersionReader reader(*this);
+    return segment(*reader.version,handle);
+  }
+
+  template <class Kernel>
+  const memory::Arena& BasicPolygonalSubdivision<Kernel>::arena() const {
+    return _arena;
+  }
+
+  template <class Kernel>
+  unsigned int BasicPolygonalSubdivision<Kernel>::face_count() const {
+    if(!updated())
+      return _face_count;
+    VersionReader reader(*this);
+    return reader.version->face_count;
+  }
+
+  template <class Kernel>
+  unsigned int
+  BasicPolygonalSubdivision<Kernel>::face_above(unsigned int handle) const {
+    if(!updated())
+      return _faces[2 * handle];
+    VersionReader reader(*this);
+    return reader.version->face(2 * handle);
+  }
+
+  template <class Kernel>
+  unsigned int
+  BasicPolygonalSubdivision<Kernel>::face_below(unsigned int handle) const {
+    if(!updated())
+      return _faces[2 * handle + 1];
+    VersionReader reader(*this);
+    return reader.version->face(2 * handle + 1);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::build(unsigned int band_count,
+						concurrency::ThreadPool* pool) {
+    if(_locked)
+      return;
 
     // lock the division
     _locked = true;
@@ -73,43 +807,109 @@ namespace geometry {
     // Each time stores the line segments which span from one sweep
     // point to the next.
     // 
+    // All line segments in the structure whose right most end points
+    // lie on the sweep point should be removed from the structure
+    //
     // All line segments not in the structure whose leftmost end points
     // lie on the sweep point should be added to the structure
     //
-    // - store segments on a stack in increasing order of left end
-    //   point
+    // The removals come first, so that a segment ending at the sweep
+    // point is never compared against one starting there.
     //
-    // All line segments in the structure whose right most end points
-    // lie on the sweep point should be removed from the structure
+    // Vertical segments are kept aside, at the end of the table.
+    //
+    // The structure holds handles into the table, and the events are
+    // visited in order, once.
     ///////////////////////////////////////////////////////////////////////////
-    sort(line_segments_left.begin(),line_segments_left.end(),leftDescX);
+    vector<SweepEvent> events;
+    sort_events(events);
+    slab_directory.build(sweep_points.empty() ? 0 : &sweep_points[0],
+			 sweep_points.size());
+    label_faces(events);
+
+    slab_sizes.assign(sweep_points.size(),0);
+
+    if(_engine == TRAPEZOIDAL_MAP) {
+      // a fixed seed, so that the map is the same on every run
+      trapezoidal_map.build(_segments,_non_vertical,1);
+      return;
+    }
+    if(_engine == TRIANGULATION_HIERARCHY) {
+      triangulation_hierarchy.build(_segments,_non_vertical);
+      return;
+    }
+
+    // split the slabs evenly between the bands
+    if(band_count > sweep_points.size())
+      band_count = sweep_points.size();
+    if(band_count == 0)
+      band_count = 1;
+    for(unsigned int i = 0; i < band_count; ++i) {
+      band_starts.push_back(sweep_points.size() * i / band_count);
+      bands.push_back(new PersistentSkipList< handle_t >());
+    }
+
+    if(pool == 0 || band_count == 1) {
+      for(unsigned int i = 0; i < band_count; ++i)
+	build_band(i,events);
+      return;
+    }
+
+    BandBuildTask<Kernel> task(*this,events);
+    pool->run(task);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::build_band(unsigned int band,
+						     const vector<SweepEvent>&
+						     events) {
+    unsigned int first = band_starts[band];
+    unsigned int last = band + 1 < band_starts.size() ?
+      band_starts[band + 1] : sweep_points.size();
+    if(first == last)
+      return;
+    // the skip list compares its handles through the table
+    typename handle_t::Scope scope(_segments);
+    PersistentSkipList< handle_t >& psl = *bands[band];
+    const coord_t& start = sweep_points[first];
+
+    // number of segments in the present version
+    unsigned int size = 0;
 
-    for(set< coord_t >::iterator coord = x_coords.begin();
-	coord != x_coords.end();
-	++coord) {
-      clog << "Considering x=" << *coord << endl;
+    // seed the band with the segments which span its left boundary; the
+    // ones ending on it are left out rather than removed
+    for(unsigned int seed = 0;
+	seed < _non_vertical && _segments[seed].getLeftEndPoint().x < start;
+	++seed) {
+      if(start < _segments[seed].getRightEndPoint().x) {
+	TRACE(TRACE_SWEEP,TRACE_DEBUG,
+	      "Seeding segment: " << _segments[seed]);
+	psl.insert(handle_t(seed));
+	++size;
+      }
+    }
+    // the removals on the boundary are of segments which were left out
+    unsigned int next = int(lower_bound(events.begin(),
+					events.end(),
+					SweepEvent(start,SweepEvent::INSERT,0))
+			    - events.begin());
+
+    for(unsigned int index = first; index < last; ++index) {
+      const coord_t& coord = sweep_points[index];
+      TRACE(TRACE_SWEEP,TRACE_DEBUG,"Considering x=" << coord);
       int present = psl.getPresent();
-      // add points whose left end points are on the sweep line
-      {
-	LineSegment& line = line_segments_left.back();
-	while(line_segments_left.size() > 0 &&
-	      line.getLeftEndPoint().x <= (*coord)) {
-	  clog << "Considering segment for insertion: " << line << endl;
-	  if(line.isVertical()) {
-	    clog << "Too vertical." << endl;
-	    if(vertical_lines.count(line.getFirstEndPoint().x) == 0)
-	      vertical_lines[line.getFirstEndPoint().x] =
-		vector<LineSegment>();
-	    vertical_lines[line.getFirstEndPoint().x].push_back(line);
-	    line_segments_left.pop_back();
-	    line = line_segments_left.back();
-	    continue;
-	  }
+      // the events on the sweep line: the removals of the segments whose
+      // right end points are on it, then the insertions of those whose
+      // left end points are
+      for(; next < events.size() && !(coord < events[next].x); ++next) {
+	handle_t line(events[next].segment);
+	if(events[next].kind == SweepEvent::VERTICAL)
+	  continue;
+	if(events[next].kind == SweepEvent::INSERT) {
 	  try {
-	    // DEBUG
-	    clog << "Inserting..." << endl;
-	    // END DEBUG
+	    TRACE(TRACE_SWEEP,TRACE_DEBUG,"Inserting segment: " << line);
 	    psl.insert(line);
+	    ++size;
 	  } catch(char const* exception) {
 	    psl.drawPresent();
 	    stringstream ss;
@@ -117,137 +917,1363 @@ namespace geometry {
 	       << "Found: " << *(psl.find(line,present)) << endl;
 	    throw ss.str();
 	  }
-	  if(line_segments_right.count(line.getRightEndPoint().x) == 0) {
-	    line_segments_right[line.getRightEndPoint().x] =
-	      vector<LineSegment>();
-	  }
-	  line_segments_right[line.getRightEndPoint().x].push_back(line);
-	  line_segments_left.pop_back();
-	  line = line_segments_left.back();
+	  continue;
 	}
-      }
-      clog << "Done insertions" <<endl;
-      // remove points whose right end points are at most the sweep line
-      {
-	vector<LineSegment>::iterator it =
-	  line_segments_right[*coord].begin();
-	vector<LineSegment>::iterator end = 
-	  line_segments_right[*coord].end();
-	while(it != end) {
-	  clog << "Deleting segment: " << *it << endl;
-	  PSLIterator<LineSegment> toRemove = psl.find((*it),present);
-	  if((*it) != (*toRemove)) {
-	    clog << "=== ERROR ===" << endl
-		 << "Deletion mismatch" << endl
-		 << "Sought: " << (*it) << endl
-		 << "Found:  " << (*toRemove) << endl;
+	TRACE(TRACE_SWEEP,TRACE_DEBUG,"Deleting segment: " << line);
+	PSLIterator<handle_t> toRemove = psl.find(line,present);
+	if(TRACE_ENABLED(TRACE_SWEEP,TRACE_ERROR) && line != (*toRemove)) {
+	  TRACE(TRACE_SWEEP,TRACE_ERROR,
+		"Deletion mismatch, sought: " << line
+		<< " found: " << (*toRemove));
+	  stringstream contents;
 #ifndef NDEBUG
-	    clog << "Search path: ";
-	    for(vector<LineSegment>::iterator path_item = psl.lastSearchPath.begin();
-		path_item != psl.lastSearchPath.end();
-		++path_item)
-	      clog << *path_item << ", ";
-	    clog << endl;
+	  for(typename vector<handle_t>::iterator path_item = psl.lastSearchPath.begin();
+	      path_item != psl.lastSearchPath.end();
+	      ++path_item)
+	    contents << *path_item << ", ";
+	  TRACE(TRACE_SWEEP,TRACE_ERROR,"Search path: " << contents.str());
+	  contents.str("");
 #endif
-	    clog << "Printing contents of psl: " << endl;
-	    for(PSLIterator<LineSegment> psl_it = psl.begin(present);
-		psl_it != psl.end(present);
-		++psl_it) {
-	      clog << *psl_it << ", ";
-	    }
-	    clog << endl;
+	  for(PSLIterator<handle_t> psl_it = psl.begin(present);
+	      psl_it != psl.end(present);
+	      ++psl_it) {
+	    contents << *psl_it << ", ";
 	  }
-	  assert((*it) == (*toRemove));
-	  toRemove.remove();
-	  ++it;
+	  TRACE(TRACE_SWEEP,TRACE_ERROR,"Contents of psl: " << contents.str());
 	}
-	line_segments_right.erase(*coord);
+	assert(line == (*toRemove));
+	toRemove.remove();
+	--size;
       }
-      psl.drawPresent();
+      if(TRACE_ENABLED(TRACE_SWEEP,TRACE_VERBOSE))
+	psl.drawPresent();
       psl.incTime();
-      sweep_points.push_back(*coord);
+      slab_sizes[index] = size;
     }
   }
+
+  // the skip list holding the version of slab index, and its time there
+  template <class Kernel>
+  PersistentSkipList< typename BasicPolygonalSubdivision<Kernel>::handle_t >&
+  BasicPolygonalSubdivision<Kernel>::version(unsigned int index,
+					     int& time) const {
+    unsigned int band = int(upper_bound(band_starts.begin(),
+					band_starts.end(),
+					index)
+			    - band_starts.begin()) - 1;
+    time = index - band_starts[band];
+    return *bands[band];
+  }
   
-  QueryResult PolygonalSubdivision::locate_point(const Point2D& p) {
+  // the handles of the segments directly above and below p in slab
+  // index, as PersistentSkipList::find and the following element give
+  // them
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::neighbours(unsigned int index,
+						     const point_t& p,
+						     unsigned int& above,
+						     unsigned int& below) const {
+    if(_engine == TRAPEZOIDAL_MAP) {
+      trapezoidal_map.locate(p,above,below);
+      return;
+    }
+    if(_engine == TRIANGULATION_HIERARCHY) {
+      triangulation_hierarchy.locate(p,above,below);
+      return;
+    }
+    if(frozen()) {
+      unsigned int position = slab_index.search(index,p);
+      above = position > 0 ? slab_index.handle(index,position - 1) : NONE;
+      below = position < slab_index.size(index) ?
+	slab_index.handle(index,position) : NONE;
+      return;
+    }
+    typename handle_t::Scope scope(_segments,&p);
+    int time;
+    PSLIterator<handle_t> it =
+      version(index,time).find(handle_t(handle_t::KEY),time);
+    above = (*it).index;
+    ++it;
+    below = (*it).index;
+  }
+
+  template <class Kernel>
+  bool BasicPolygonalSubdivision<Kernel>::rectilinear() const {
+    return _rectilinear;
+  }
+
+  template <class Kernel>
+  bool BasicPolygonalSubdivision<Kernel>::frozen() const {
+    return !slab_index.empty();
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::freeze() {
+    if(!_locked)
+      throw "PolygonalSubdivision must be locked before use";
+    if(frozen() || _engine != PERSISTENT_SKIP_LIST)
+      return;
+
+    unsigned int total = 0;
+    for(unsigned int i = 0; i < slab_sizes.size(); ++i)
+      total += slab_sizes[i];
+    vector<unsigned int> offsets(1,0);
+    offsets.reserve(sweep_points.size() + 1);
+    vector<unsigned int> runs;
+    runs.reserve(total);
+
+    // the versions already hold handles, which the runs are made of
+    for(unsigned int slab = 0; slab < sweep_points.size(); ++slab) {
+      int time;
+      PersistentSkipList< handle_t >& psl = version(slab,time);
+      for(PSLIterator<handle_t> it = psl.begin(time);
+	  it != psl.end(time);
+	  ++it)
+	runs.push_back((*it).index);
+      offsets.push_back(runs.size());
+    }
+
+    slab_index.assign(_segments,_segment_count,offsets,runs,_rectilinear);
+
+    // the index answers all queries from now on
+    for(unsigned int i = 0; i < bands.size(); ++i)
+      delete bands[i];
+    bands.clear();
+    band_starts.clear();
+  }
+
+  // tells the built-in kernels apart in a snapshot, by their traits and
+  // the size of their coordinates
+  template <class Kernel>
+  uint32_t snapshotKernel() {
+    return (Kernel::is_exact ? 1 : 0) |
+      (Kernel::is_field ? 2 : 0) |
+      (Kernel::is_pod ? 4 : 0) |
+      (uint32_t(sizeof(typename Kernel::coord_t)) << 8);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::save(const char* path) const {
+    if(!frozen())
+      throw "Only a frozen PolygonalSubdivision can be saved";
+    if(updated())
+      throw "An updated PolygonalSubdivision cannot be saved";
+
+    SnapshotHeader header;
+    memset(&header,0,sizeof(header));
+    header.kernel = snapshotKernel<Kernel>();
+    header.segment_bytes = sizeof(segment_t);
+    header.sweep_points = sweep_points.size();
+    header.verticals = _segment_count - _non_vertical;
+    header.segments = _segment_count;
+    header.slabs = slab_index.slab_count();
+    header.runs = slab_index.offsets()[slab_index.slab_count()];
+    header.faces = _face_count;
+    if(_rectilinear)
+      header.flags |= SNAPSHOT_RECTILINEAR;
+
+    SnapshotWriter out(path);
+    if(Kernel::is_pod) {
+      out.section(sweep_points.empty() ? 0 : &sweep_points[0],
+		  sweep_points.size() * sizeof(coord_t));
+      out.section(_segments,header.segments * sizeof(segment_t));
+    } else {
+      // coordinates which cannot be copied as bytes are written as text
+      stringstream text;
+      for(unsigned int i = 0; i < sweep_points.size(); ++i)
+	text << sweep_points[i] << endl;
+      for(unsigned int i = 0; i < header.segments; ++i)
+	text << _segments[i] << endl;
+      string contents = text.str();
+      uint64_t length = contents.size();
+      out.section(&length,sizeof(length));
+      out.section(contents.data(),length);
+    }
+    out.section(slab_index.offsets(),
+		(header.slabs + 1) * sizeof(unsigned int));
+    out.section(slab_index.runs(),header.runs * sizeof(unsigned int));
+    out.section(_faces,2 * header.segments * sizeof(unsigned int));
+    out.finish(header);
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::load(const char* path, bool verify) {
+    if(_locked || !line_segments_left.empty())
+      throw "Only a new PolygonalSubdivision can be loaded";
+
+    snapshot.open(path,verify);
+    const SnapshotHeader& header = snapshot.header();
+    if(header.kernel != snapshotKernel<Kernel>() ||
+       header.segment_bytes != sizeof(segment_t))
+      throw string("Snapshot written with another kernel: ") + path;
+    if(header.slabs != header.sweep_points ||
+       header.verticals > header.segments)
+      throw string("Inconsistent snapshot: ") + path;
+
+    if(Kernel::is_pod) {
+      // the table is used where it lies; the sweep points are few, and
+      // copied
+      const coord_t* xs = reinterpret_cast<const coord_t*>
+	(snapshot.section(header.sweep_points * sizeof(coord_t)));
+      sweep_points.assign(xs,xs + header.sweep_points);
+      use_table(reinterpret_cast<const segment_t*>
+		(snapshot.section(header.segments * sizeof(segment_t))),
+		header.segments,
+		header.verticals,
+		(header.flags & SNAPSHOT_RECTILINEAR) != 0);
+    } else {
+      uint64_t length;
+      memcpy(&length,snapshot.section(sizeof(length)),sizeof(length));
+      istringstream text(string(snapshot.section(length),length));
+      sweep_points.resize(header.sweep_points);
+      for(unsigned int i = 0; i < sweep_points.size(); ++i)
+	text >> sweep_points[i];
+      segment_table.resize(header.segments);
+      for(unsigned int i = 0; i < segment_table.size(); ++i)
+	text >> segment_table[i];
+      if(!text)
+	throw string("Corrupt snapshot: ") + path;
+      use_table(segment_table.empty() ? 0 : &segment_table[0],
+		header.segments,
+		header.verticals,
+		(header.flags & SNAPSHOT_RECTILINEAR) != 0);
+    }
+    const unsigned int* offsets = reinterpret_cast<const unsigned int*>
+      (snapshot.section((header.slabs + 1) * sizeof(unsigned int)));
+    const unsigned int* runs = reinterpret_cast<const unsigned int*>
+      (snapshot.section(header.runs * sizeof(unsigned int)));
+    if(offsets[header.slabs] != header.runs)
+      throw string("Inconsistent snapshot: ") + path;
+    // the faces are plain indices, used where they lie
+    _faces = reinterpret_cast<const unsigned int*>
+      (snapshot.section(2 * header.segments * sizeof(unsigned int)));
+    _face_count = header.faces;
+
+    if(Kernel::is_pod) {
+      slab_index.view(_segments,
+		      _segment_count,
+		      offsets,
+		      runs,
+		      header.slabs,
+		      _rectilinear);
+    } else {
+      vector<unsigned int> offset_copy(offsets,offsets + header.slabs + 1);
+      vector<unsigned int> run_copy(runs,runs + header.runs);
+      slab_index.assign(_segments,
+			_segment_count,
+			offset_copy,
+			run_copy,
+			_rectilinear);
+    }
+    slab_directory.build(sweep_points.empty() ? 0 : &sweep_points[0],
+			 sweep_points.size());
+    _locked = true;
+  }
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::check_queryable() const {
     // basic error checking
     if(!_locked)
       throw "PolygonalSubdivision must be locked before use";
-    if(psl.empty(0))
+    if(sweep_points.empty())
       throw "No line segments";
+  }
 
-    unsigned int index = int(lower_bound(sweep_points.begin(),
-					 sweep_points.end(),
-					 p.x)
-			     - sweep_points.begin());
+  // Finds the index of the slab, the last sweep point not right of p.
+  // Returns false if p is left of the first sweep line.
+  template <class Kernel>
+  bool BasicPolygonalSubdivision<Kernel>::find_slab(const point_t& p,
+						    unsigned int& index) const {
+    index = slab_directory.find(p.x);
+    if(index == 0)
+      return false;
+    --index;
+    return true;
+  }
 
-    if(p.x != sweep_points[index] && index > 0)
-      --index;
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::result_t
+  BasicPolygonalSubdivision<Kernel>::locate_point(const point_t& p) const {
+    check_queryable();
+    if(updated()) {
+      VersionReader reader(*this);
+      return locate_updated(p,*reader.version);
+    }
 
+    unsigned int index;
     // check if left of first sweep line
-    if(index == 0 && p.x < sweep_points[index])
-      return QueryResult(LineSegment(0,0),
-			 LineSegment(0,0),
-			 true); // outer
+    if(!find_slab(p,index))
+      return result_t(NONE,NONE,true); // outer
 
-    LineSegment toFind(p,p);
-    
-    PSLIterator<LineSegment> it = psl.find(toFind,index);
-    LineSegment above = *it;
-    ++it;
-    LineSegment below = *it;
+    unsigned int above, below;
+    neighbours(index,p,above,below);
+
+    return classify(p,index,above,below);
+  }
+
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::result_t
+  BasicPolygonalSubdivision<Kernel>::locate_point(const point_t& p,
+						  cursor_t& cursor) const {
+    check_queryable();
+    if(updated()) {
+      // the slabs of one index do not bound the neighbours
+      cursor.valid = false;
+      ++cursor.misses;
+      VersionReader reader(*this);
+      return locate_updated(p,*reader.version);
+    }
+
+    if(cursor.valid) {
+      unsigned int index = cursor.slab;
+      if(!in_slab(p,index)) {
+	if(index + 1 < sweep_points.size() && in_slab(p,index + 1))
+	  ++index;
+	else if(index > 0 && in_slab(p,index - 1))
+	  --index;
+      }
+      if(in_slab(p,index)) {
+	// The neighbours are consecutive in the slab, so p lies between
+	// them if it is not above the one above nor below the one below.
+	// A missing neighbour is past the end of the slab.
+	if(index == cursor.slab &&
+	   (cursor.above == NONE ||
+	    !BasicSlabOrder<Kernel>::less(p,_segments[cursor.above])) &&
+	   (cursor.below == NONE ||
+	    BasicSlabOrder<Kernel>::less(p,_segments[cursor.below]))) {
+	  ++cursor.hits;
+	  return classify(p,index,cursor.above,cursor.below);
+	}
+	++cursor.near_hits;
+	cursor.slab = index;
+	locate_in_slab(p,cursor);
+	return classify(p,index,cursor.above,cursor.below);
+      }
+    }
+
+    ++cursor.misses;
+    if(!find_slab(p,cursor.slab)) {
+      cursor.valid = false;
+      return result_t(NONE,NONE,true); // outer
+    }
+    cursor.valid = true;
+    locate_in_slab(p,cursor);
+    return classify(p,cursor.slab,cursor.above,cursor.below);
+  }
+
+  // whether p is in slab index, between its sweep point and the next
+  template <class Kernel>
+  bool BasicPolygonalSubdivision<Kernel>::in_slab(const point_t& p,
+						  unsigned int index) const {
+    return !(p.x < sweep_points[index]) &&
+      (index + 1 == sweep_points.size() || p.x < sweep_points[index + 1]);
+  }
+
+  // Finds the neighbours of p in the cursor's slab, galloping from
+  // the cursor's position when frozen.
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::locate_in_slab(const point_t& p,
+							 cursor_t& cursor) const {
+    unsigned int index = cursor.slab;
+    if(frozen()) {
+      unsigned int position = slab_index.search(index,p,cursor.position);
+      cursor.position = position;
+      cursor.above = position > 0 ?
+	slab_index.handle(index,position - 1) : NONE;
+      cursor.below = position < slab_index.size(index) ?
+	slab_index.handle(index,position) : NONE;
+      return;
+    }
+    neighbours(index,p,cursor.above,cursor.below);
+  }
+
+  // Given the handles of the segments directly above and below p in slab
+  // index, decides what p is on, and the face below the segment above.
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::result_t
+  BasicPolygonalSubdivision<Kernel>::classify(const point_t& p,
+					      unsigned int index,
+					      unsigned int above,
+					      unsigned int below) const {
+    result_t result = feature(p,index,above,below);
+    result.face = above == NONE ? OUTER_FACE : _faces[2 * above + 1];
+    return result;
+  }
+
+  // decides whether p is on a vertex, an edge, a face or outside
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::result_t
+  BasicPolygonalSubdivision<Kernel>::feature(const point_t& p,
+					     unsigned int index,
+					     unsigned int above,
+					     unsigned int below) const {
+    bool on_sweep_line = p.x == sweep_points[index];
+    return touching(p,
+		    on_sweep_line,
+		    on_sweep_line ? vertical_through(p) : NONE,
+		    above,
+		    segment(above),
+		    below,
+		    segment(below));
+  }
+
+  // The handle of the vertical segment whose inside p lies on, or NONE.
+  // They end the table, ordered by x and then from the bottom, and those
+  // on one line do not overlap, so only the last one starting below p
+  // may pass through it.
+  template <class Kernel>
+  unsigned int
+  BasicPolygonalSubdivision<Kernel>::vertical_through(const point_t& p) const {
+    const segment_t* begin = _segments + _non_vertical;
+    const segment_t* it = lower_bound(begin,
+				      _segments + _segment_count,
+				      p,
+				      BottomBefore<segment_t>());
+    if(it != begin &&
+       (*--it).getBottomEndPoint().x == p.x &&
+       p.y < (*it).getTopEndPoint().y)
+      return it - _segments;
+    return NONE;
+  }
 
+  // As feature(), given the segments a and b above and below p, and the
+  // vertical one through p, found only if p is on a sweep line.
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::result_t
+  BasicPolygonalSubdivision<Kernel>::touching(const point_t& p,
+					      bool on_sweep_line,
+					      unsigned int vertical,
+					      unsigned int above,
+					      const segment_t& a,
+					      unsigned int below,
+					      const segment_t& b) {
     // check if query point was on sweep line
-    if(p.x == sweep_points[index]) {
+    if(on_sweep_line) {
       // check if query point is on a vertical line
-      for(vector<LineSegment>::iterator it = vertical_lines[p.x].begin();
-	  it != vertical_lines[p.x].end();
-	  ++it) {
-	if(p.y < (*it).getTopEndPoint().y && p.y > (*it).getBottomEndPoint().y)
-	  return QueryResult(*it,
-			     *it,
-			     false, // outer
-			     false, // vertex
-			     true); // edge
-      }
+      if(vertical != NONE)
+	return result_t(vertical,
+			vertical,
+			false, // outer
+			false, // vertex
+			true); // edge
 
       // check if query point is on a vertex
-      if(p == above.getFirstEndPoint() ||
-	 p == above.getSecondEndPoint())
-	return QueryResult(above,
-			   above,
-			   false, // outer
-			   true); // vertex
-      if(p == below.getFirstEndPoint() ||
-	 p == below.getSecondEndPoint())
-	return QueryResult(below,
-			   below,
-			   false, // outer
-			   true); // vertex
+      if(p == a.getFirstEndPoint() ||
+	 p == a.getSecondEndPoint())
+	return result_t(above,
+			above,
+			false, // outer
+			true); // vertex
+      if(p == b.getFirstEndPoint() ||
+	 p == b.getSecondEndPoint())
+	return result_t(below,
+			below,
+			false, // outer
+			true); // vertex
 
       // otherwise, point must be on a face, so proceed normally
     }
 
-    // check if query point was on the above line
-    if(toFind <= above && toFind >= above) {
-      return QueryResult(above,
-			 above,
-			 false, // outer
-			 false, // vertex
-			 true); // edge
-    } else if(toFind <= below && toFind >= below) {
-      return QueryResult(below,
-			 below,
-			 false, // outer
-			 false, // vertex
-			 true); // edge
-    }
-
-    bool outer =
-	below == LineSegment(0,0,0,0) ||
-	above == LineSegment(0,0,0,0);
+    // a point inside a non-vertical edge is not told apart from one
+    // just above it: the search leaves the edge below it
+    bool outer = below == NONE || above == NONE;
     
-    return QueryResult(above,below,outer);
+    return result_t(above,below,outer);
+  }
+
+  // orders indices of query points by the x coordinate of the point
+  template <class Point>
+  class QueryXOrder {
+  public:
+    QueryXOrder(const Point* points) : _points(points) {}
+
+    bool operator()(unsigned int a, unsigned int b) const {
+      return _points[a].x < _points[b].x;
+    }
+
+  private:
+    const Point* _points;
+  };
+
+  // orders indices of query points from the highest point down
+  template <class Point>
+  class QueryYOrder {
+  public:
+    QueryYOrder(const Point* points) : _points(points) {}
+
+    bool operator()(unsigned int a, unsigned int b) const {
+      return _points[b].y < _points[a].y;
+    }
+
+  private:
+    const Point* _points;
+  };
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::locate_points(const point_t* begin,
+							const point_t* end,
+							result_t* out) const {
+    check_queryable();
+    if(updated()) {
+      VersionReader reader(*this);
+      for(const point_t* p = begin; p != end; ++p)
+	*out++ = locate_updated(*p,*reader.version);
+      return;
+    }
+
+    unsigned int n = end - begin;
+    vector<unsigned int> order(n);
+    for(unsigned int i = 0; i < n; ++i)
+      order[i] = i;
+    sort(order.begin(),order.end(),QueryXOrder<point_t>(begin));
+
+    // queries left of the first sweep line are outside
+    unsigned int next = 0;
+    while(next < n && begin[order[next]].x < sweep_points[0]) {
+      out[order[next]] = result_t(NONE,NONE,true); // outer
+      ++next;
+    }
+
+    // the version of the current slab, when it is searched as an array
+    vector<unsigned int> slab;
+    // the position of the last query, when frozen
+    unsigned int hint = 0;
+    unsigned int index = 0;
+    while(next < n) {
+      // advance to the slab of the next query
+      while(index + 1 < sweep_points.size() &&
+	    !(begin[order[next]].x < sweep_points[index + 1]))
+	++index;
+
+      // the queries in this slab are order[next..last)
+      unsigned int last = next + 1;
+      while(last < n &&
+	    (index + 1 == sweep_points.size() ||
+	     begin[order[last]].x < sweep_points[index + 1]))
+	++last;
+      TRACE(TRACE_QUERY,TRACE_DEBUG,
+	    "Slab " << index << ": " << (last - next) << " queries");
+
+      if(frozen()) {
+	// Searched from the top down, each query gallops from the
+	// position of the one before, which is often close by.  The
+	// position also carries over to the next slab, whose order is
+	// mostly the same.
+	sort(order.begin() + next,order.begin() + last,
+	     QueryYOrder<point_t>(begin));
+	for(; next < last; ++next) {
+	  const point_t& p = begin[order[next]];
+	  hint = slab_index.search(index,p,hint);
+	  unsigned int above = hint > 0 ?
+	    slab_index.handle(index,hint - 1) : NONE;
+	  unsigned int below = hint < slab_index.size(index) ?
+	    slab_index.handle(index,hint) : NONE;
+	  out[order[next]] = classify(p,index,above,below);
+	}
+	continue;
+      }
+
+      // Copying the version costs about one step per segment, while
+      // each find costs about log2(size) steps, so a version is only
+      // copied when enough queries fall in its slab.
+      unsigned int size = slab_sizes[index];
+      unsigned int steps = 1;
+      while((1u << steps) <= size && steps < 32)
+	++steps;
+      bool materialize =
+	_engine == PERSISTENT_SKIP_LIST && (last - next) * steps > size;
+      if(materialize) {
+	slab.clear();
+	int time;
+	PersistentSkipList< handle_t >& psl = version(index,time);
+	for(PSLIterator<handle_t> it = psl.begin(time);
+	    it != psl.end(time);
+	    ++it)
+	  slab.push_back((*it).index);
+      }
+
+      for(; next < last; ++next) {
+	const point_t& p = begin[order[next]];
+	unsigned int above, below;
+	if(materialize) {
+	  // the segments not below p, as psl.find would give
+	  unsigned int position = int(upper_bound(slab.begin(),
+						  slab.end(),
+						  p,
+						  KeyBefore<segment_t>(_segments))
+				      - slab.begin());
+	  above = position > 0 ? slab[position - 1] : NONE;
+	  below = position < slab.size() ? slab[position] : NONE;
+	} else {
+	  neighbours(index,p,above,below);
+	}
+	out[order[next]] = classify(p,index,above,below);
+      }
+    }
+  }
+
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::locate_points_interleaved(const point_t*
+							       begin,
+							       const point_t*
+							       end,
+							       result_t* out,
+							       unsigned int
+							       group) const {
+    check_queryable();
+
+    if(!frozen() || group < 2 || updated()) {
+      for(const point_t* p = begin; p != end; ++p)
+	*out++ = locate_point(*p);
+      return;
+    }
+
+    // the slab, point and place in the batch of each search of a group,
+    // and the bounds of the searches
+    vector<unsigned int> slabs(group);
+    vector<const point_t*> points(group);
+    vector<unsigned int> which(group);
+    vector<unsigned int> low(group);
+    vector<unsigned int> high(group);
+    unsigned int n = end - begin;
+    for(unsigned int first = 0; first < n; first += group) {
+      unsigned int last = n - first < group ? n : first + group;
+      for(unsigned int i = first; i < last; ++i)
+	slab_directory.prefetch(begin[i].x);
+      unsigned int count = 0;
+      for(unsigned int i = first; i < last; ++i) {
+	if(!find_slab(begin[i],slabs[count])) {
+	  out[i] = result_t(NONE,NONE,true); // outer
+	  continue;
+	}
+	points[count] = begin + i;
+	which[count] = i;
+	++count;
+      }
+      slab_index.search(count,&slabs[0],&points[0],&low[0],&high[0]);
+      // the neighbours, and the faces below the ones above, are loaded
+      // for all the group before they are classified
+      for(unsigned int j = 0; j < count; ++j) {
+	unsigned int index = slabs[j];
+	unsigned int position = low[j];
+	low[j] = position > 0 ? slab_index.handle(index,position - 1) : NONE;
+	high[j] = position < slab_index.size(index) ?
+	  slab_index.handle(index,position) : NONE;
+	if(low[j] != NONE) {
+	  __builtin_prefetch(_faces + 2 * low[j] + 1);
+	  __builtin_prefetch(_segments + low[j]);
+	}
+	if(high[j] != NONE)
+	  __builtin_prefetch(_segments + high[j]);
+      }
+      for(unsigned int j = 0; j < count; ++j)
+	out[which[j]] = classify(*points[j],slabs[j],low[j],high[j]);
+    }
+  }
+
+  // locates the chunks of a batch which a worker takes from the queue
+  template <class Kernel>
+  class BatchQueryTask : public concurrency::ThreadPool::Task {
+  public:
+    typedef BasicPolygonalSubdivision<Kernel> subdivision_t;
+    typedef typename subdivision_t::point_t point_t;
+    typedef typename subdivision_t::result_t result_t;
+
+    BatchQueryTask(const subdivision_t& subdivision,
+		   const point_t* points,
+		   result_t* out,
+		   concurrency::WorkQueue& queue)
+      : _subdivision(subdivision),
+	_points(points),
+	_out(out),
+	_queue(queue)
+    {}
+
+    void run(unsigned int worker) {
+      unsigned int begin, end;
+      while(_queue.next(worker,begin,end))
+	_subdivision.locate_points(_points + begin,_points + end,_out + begin);
+    }
+
+  private:
+    const subdivision_t& _subdivision;
+    const point_t* _points;
+    result_t* _out;
+    concurrency::WorkQueue& _queue;
+  };
+
+  // The smallest chunk handed to a worker, large enough that sorting
+  // it and searching its slabs outweighs taking it from the queue.
+  const unsigned int MIN_QUERY_CHUNK = 1024;
+
+  // Chunks per worker, so that stolen chunks can even out slabs which
+  // are slower to search.
+  const unsigned int QUERY_CHUNKS_PER_WORKER = 16;
+
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::locate_points(const point_t* begin,
+							const point_t* end,
+							result_t* out,
+							concurrency::ThreadPool& pool) const {
+    // fail before starting the workers, rather than in each of them
+    check_queryable();
+
+    unsigned int n = end - begin;
+    unsigned int grain = n / (pool.size() * QUERY_CHUNKS_PER_WORKER);
+    if(grain < MIN_QUERY_CHUNK)
+      grain = MIN_QUERY_CHUNK;
+    concurrency::WorkQueue queue(n,pool.size(),grain);
+    BatchQueryTask<Kernel> task(*this,begin,out,queue);
+    pool.run(task);
+  }
+
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::locate_points_offline(const point_t* begin,
+							   const point_t* end,
+							   result_t* out) {
+    if(_locked)
+      throw "PolygonalSubdivision must not be locked for an offline sweep";
+
+    vector<SweepEvent> events;
+    sort_events(events);
+    if(sweep_points.empty())
+      throw "No line segments";
+    label_faces(events);
+
+    unsigned int n = end - begin;
+    vector<unsigned int> order(n);
+    for(unsigned int i = 0; i < n; ++i)
+      order[i] = i;
+    sort(order.begin(),order.end(),QueryXOrder<point_t>(begin));
+
+    // queries left of the first sweep line are outside
+    unsigned int next = 0;
+    while(next < n && begin[order[next]].x < sweep_points[0]) {
+      out[order[next]] = result_t(NONE,NONE,true); // outer
+      ++next;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // The same sweep as build_band, except that only the present version
+    // is kept, and the queries in each slab are answered from it before
+    // the sweep moves on.  A multiset orders the segments as the skip
+    // list does, keeping any duplicates.
+    ///////////////////////////////////////////////////////////////////////////
+    typename handle_t::Scope scope(_segments);
+    multiset<handle_t> present;
+    unsigned int next_event = 0;
+    for(unsigned int index = 0; index < sweep_points.size() && next < n;
+	++index) {
+      const coord_t& coord = sweep_points[index];
+      for(; next_event < events.size() && !(coord < events[next_event].x);
+	  ++next_event) {
+	handle_t line(events[next_event].segment);
+	if(events[next_event].kind == SweepEvent::REMOVE)
+	  present.erase(present.find(line));
+	else if(events[next_event].kind == SweepEvent::INSERT)
+	  present.insert(line);
+      }
+
+      for(; next < n &&
+	    (index + 1 == sweep_points.size() ||
+	     begin[order[next]].x < sweep_points[index + 1]);
+	  ++next) {
+	const point_t& p = begin[order[next]];
+	typename handle_t::Scope key(_segments,&p);
+	typename multiset<handle_t>::const_iterator it =
+	  present.upper_bound(handle_t(handle_t::KEY));
+	unsigned int below = it != present.end() ? (*it).index : NONE;
+	unsigned int above = it != present.begin() ? (*--it).index : NONE;
+	out[order[next]] = classify(p,index,above,below);
+      }
+    }
+
+    // nothing is kept, so the subdivision is as if new
+    vector<coord_t>().swap(sweep_points);
+    vector<segment_t>().swap(segment_table);
+    use_table(0,0,0,false);
+    vector<unsigned int>().swap(face_table);
+    _faces = 0;
+    _face_count = 0;
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Updates keep the frozen index as it is and pass over the segments
+  // removed from it, until compact() finds so many removed that it indexes
+  // the present ones again.  The added segments are indexed by the
+  // logarithmic method: each update indexes its own segments with those of
+  // the smallest indexes of the last version which are no larger than they
+  // are together, so that the indexes grow in size geometrically, and a
+  // segment is indexed again only when its index is taken over.  A query
+  // takes the nearest present segments above and below it over all of them,
+  // which are those of the slab of a subdivision locked with the present
+  // segments alone, and decides what it is on as feature() does.
+  //
+  // The faces which the edit changes are those touching a removed segment
+  // or containing an added one; the others keep their sides and IDs.  The
+  // present segments around the touched faces and the added ones are
+  // labelled as a subdivision of their own.  Its faces lying where the
+  // touched ones did are those of the updated subdivision there, since
+  // every segment bounding them is among those labelled, and the others
+  // are left as they are.
+  ///////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::update(const segment_t* insert_begin,
+						 const segment_t* insert_end,
+						 const segment_t* remove_begin,
+						 const segment_t* remove_end) {
+    if(!frozen())
+      throw "Only a frozen PolygonalSubdivision can be updated";
+
+    Version* first = _version == 0 ? first_version() : 0;
+    const Version& current = first != 0 ? *first : *_version;
+    Version* next = 0;
+    vector<unsigned int> removed;
+    vector<unsigned int> touched;
+    vector<unsigned int> relabelled;
+    try {
+      for(const segment_t* s = remove_begin; s != remove_end; ++s) {
+	unsigned int handle = find_handle(current,*s);
+	if(handle == NONE) {
+	  stringstream ss;
+	  ss << "No such segment to remove: " << *s;
+	  throw ss.str();
+	}
+	removed.push_back(handle);
+      }
+      sort(removed.begin(),removed.end());
+      removed.erase(unique(removed.begin(),removed.end()),removed.end());
+      touched_faces(current,insert_begin,insert_end,removed,touched);
+
+      // the added segments are written past those of the current version,
+      // where its queries do not read
+      next = new Version(current);
+      UpdateState& state = *_updates;
+      for(const segment_t* s = insert_begin; s != insert_end; ++s) {
+	unsigned int slot = next->handle_count - _segment_count;
+	unsigned int page = slot / UPDATE_PAGE;
+	if(page == state.segment_pages.size())
+	  state.segment_pages.push_back(new segment_t[UPDATE_PAGE]);
+	if(page == next->added.size())
+	  next->added.push_back(state.segment_pages[page]);
+	state.segment_pages[page][slot % UPDATE_PAGE] = *s;
+	++next->handle_count;
+      }
+      relabel(current,*next,touched,removed,relabelled);
+      merge_levels(*next,current.handle_count);
+      next->removed_count += removed.size();
+      compact(current,*next);
+    } catch(...) {
+      if(next != 0)
+	release(next,current);
+      delete first;
+      throw;
+    }
+
+    // the lists of the touched faces are made again from their new sides
+    UpdateState& state = *_updates;
+    for(unsigned int i = 0; i < touched.size(); ++i)
+      state.face_first[touched[i]] = NONE;
+    state.face_first.resize(next->face_count,NONE);
+    state.side_next.resize(2 * next->handle_count,NONE);
+    for(unsigned int i = 0; i < relabelled.size(); ++i) {
+      unsigned int face = next->face(relabelled[i]);
+      state.side_next[relabelled[i]] = state.face_first[face];
+      state.face_first[face] = relabelled[i];
+    }
+    for(unsigned int i = 0; i < removed.size(); ++i)
+      if(removed[i] >= _segment_count)
+	state.added.erase(segment(current,removed[i]));
+    for(unsigned int handle = current.handle_count;
+	handle < next->handle_count;
+	++handle)
+      state.added[segment(*next,handle)] = handle;
+
+    TRACE(TRACE_SWEEP,TRACE_INFO,
+	  "Updated: " << removed.size() << " removed, "
+	  << (next->handle_count - current.handle_count) << " added, "
+	  << touched.size() << " faces touched, "
+	  << next->levels.size() << " indexes.");
+
+    // what the version holds is written before the queries can find it
+    __sync_synchronize();
+    Version* last = _version;
+    _version = next;
+    __sync_synchronize();
+    if(last != 0) {
+      wait_for_readers();
+      release(last,*next);
+    } else {
+      release(first,*next);
+    }
+  }
+
+  template <class Kernel>
+  bool BasicPolygonalSubdivision<Kernel>::updated() const {
+    return _version != 0;
+  }
+
+  // The version before the first update, whose pages lie in _faces, and
+  // the lists of the sides of each face, made once.
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::Version*
+  BasicPolygonalSubdivision<Kernel>::first_version() {
+    if(_updates == 0) {
+      UpdateState* state = new UpdateState();
+      state->face_first.assign(_face_count,NONE);
+      state->side_next.assign(2 * _segment_count,NONE);
+      for(unsigned int side = 2 * _segment_count; side > 0; --side) {
+	unsigned int face = _faces[side - 1];
+	state->side_next[side - 1] = state->face_first[face];
+	state->face_first[face] = side - 1;
+      }
+      _updates = state;
+    }
+    Version* first = new Version();
+    for(unsigned int side = 0; side < 2 * _segment_count; side += UPDATE_PAGE)
+      first->faces.push_back(_faces + side);
+    first->handle_count = _segment_count;
+    first->face_count = _face_count;
+    return first;
+  }
+
+  // the segment of a handle in a version, added or not
+  template <class Kernel>
+  const typename BasicPolygonalSubdivision<Kernel>::segment_t&
+  BasicPolygonalSubdivision<Kernel>::segment(const Version& version,
+					     unsigned int handle) const {
+    if(handle == NONE)
+      return handle_t::none();
+    if(handle < _segment_count)
+      return _segments[handle];
+    unsigned int slot = handle - _segment_count;
+    return version.added[slot / UPDATE_PAGE][slot % UPDATE_PAGE];
+  }
+
+  // the handle of the present segment with the end points of s, or NONE
+  template <class Kernel>
+  unsigned int
+  BasicPolygonalSubdivision<Kernel>::find_handle(const Version& version,
+						 const segment_t& s) const {
+    typename map<segment_t, unsigned int,
+		 EndPointOrder<segment_t> >::const_iterator added =
+      _updates->added.find(s);
+    if(added != _updates->added.end())
+      return added->second;
+
+    // the table is sorted by left end point, then the vertical segments
+    // by lower end point, but not further
+    const segment_t* it;
+    const segment_t* end;
+    if(s.isVertical()) {
+      end = _segments + _segment_count;
+      it = lower_bound(_segments + _non_vertical,
+		       end,
+		       s.getBottomEndPoint(),
+		       BottomBefore<segment_t>());
+    } else {
+      end = _segments + _non_vertical;
+      it = lower_bound(_segments,
+		       end,
+		       s.getLeftEndPoint(),
+		       LeftBefore<segment_t>());
+    }
+    for(; it != end &&
+	  (s.isVertical() ?
+	   (*it).getBottomEndPoint() == s.getBottomEndPoint() :
+	   (*it).getLeftEndPoint().x == s.getLeftEndPoint().x);
+	++it)
+      if(*it == s && version.present(it - _segments))
+	return it - _segments;
+    return NONE;
+  }
+
+  // The faces an edit changes: those on either side of a removed segment,
+  // and those the added segments lie in, which is below the nearest
+  // segment above the start of each.  Where that is a removed segment,
+  // its face is touched anyway.
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::touched_faces(const Version& version,
+						   const segment_t*
+						   insert_begin,
+						   const segment_t*
+						   insert_end,
+						   const vector<unsigned int>&
+						   removed,
+						   vector<unsigned int>&
+						   touched) const {
+    touched.clear();
+    for(unsigned int i = 0; i < removed.size(); ++i) {
+      touched.push_back(version.face(2 * removed[i]));
+      touched.push_back(version.face(2 * removed[i] + 1));
+    }
+    for(const segment_t* s = insert_begin; s != insert_end; ++s) {
+      Nearest nearest;
+      if(version.own_index)
+	find_nearest_above(version,0,*s,nearest);
+      for(unsigned int i = 0; i < version.levels.size(); ++i) {
+	const Level& level = *version.levels[i];
+	level.index.find_nearest_above(version,&level.handles[0],*s,nearest);
+      }
+      touched.push_back(nearest.above == NONE ?
+			OUTER_FACE : version.face(2 * nearest.above + 1));
+    }
+    sort(touched.begin(),touched.end());
+    touched.erase(unique(touched.begin(),touched.end()),touched.end());
+  }
+
+  // Labels again the sides of the present segments around the touched
+  // faces and of the added ones, in next, and makes the removed ones
+  // NONE.  The new faces containing a side of a touched one take its ID,
+  // first come first, and the others are numbered after the last ID.
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::relabel(const Version& current,
+					     Version& next,
+					     const vector<unsigned int>&
+					     touched,
+					     const vector<unsigned int>&
+					     removed,
+					     vector<unsigned int>&
+					     relabelled) const {
+    const UpdateState& state = *_updates;
+    vector<unsigned int> around;
+    for(unsigned int i = 0; i < touched.size(); ++i)
+      for(unsigned int side = state.face_first[touched[i]];
+	  side != NONE;
+	  side = state.side_next[side])
+	around.push_back(side / 2);
+    sort(around.begin(),around.end());
+    around.erase(unique(around.begin(),around.end()),around.end());
+    vector<unsigned int> handles;
+    set_difference(around.begin(),around.end(),
+		   removed.begin(),removed.end(),
+		   back_inserter(handles));
+    for(unsigned int handle = current.handle_count;
+	handle < next.handle_count;
+	++handle)
+      handles.push_back(handle);
+
+    // the faces of those segments alone, whose handles are found again
+    // by their end points
+    BasicPolygonalSubdivision<Kernel> local;
+    vector<segment_t> segments(handles.size());
+    map<segment_t, unsigned int, EndPointOrder<segment_t> > by_ends;
+    for(unsigned int i = 0; i < handles.size(); ++i) {
+      segments[i] = segment(next,handles[i]);
+      by_ends[segments[i]] = handles[i];
+    }
+    local.addLineSegments(segments);
+    vector<SweepEvent> events;
+    local.sort_events(events);
+    local.label_faces(events);
+    for(unsigned int i = 0; i < local._segment_count; ++i)
+      handles[i] = by_ends[local._segments[i]];
+
+    // the local faces inside the touched ones, which hold a side of a
+    // touched face or of an added segment; the others, and the sides
+    // in them, are left as they are
+    vector<bool> inside(local._face_count,false);
+    for(unsigned int side = 0; side < 2 * local._segment_count; ++side) {
+      unsigned int handle = handles[side / 2];
+      if(handle >= current.handle_count ||
+	 binary_search(touched.begin(),touched.end(),
+		       current.face(2 * handle + side % 2)))
+	inside[local._faces[side]] = true;
+    }
+    vector<unsigned int> ids(local._face_count,NONE);
+    vector<bool> taken(touched.size(),false);
+    if(!touched.empty() && touched[0] == OUTER_FACE) {
+      ids[OUTER_FACE] = OUTER_FACE;
+      taken[0] = true;
+    }
+    for(unsigned int side = 0; side < 2 * local._segment_count; ++side) {
+      unsigned int face = local._faces[side];
+      unsigned int handle = handles[side / 2];
+      if(!inside[face] || ids[face] != NONE ||
+	 handle >= current.handle_count)
+	continue;
+      unsigned int old = current.face(2 * handle + side % 2);
+      unsigned int i = int(lower_bound(touched.begin(),touched.end(),old)
+			   - touched.begin());
+      if(i < touched.size() && touched[i] == old && !taken[i]) {
+	ids[face] = old;
+	taken[i] = true;
+      }
+    }
+
+    relabelled.clear();
+    for(unsigned int side = 0; side < 2 * local._segment_count; ++side) {
+      unsigned int face = local._faces[side];
+      if(!inside[face])
+	continue;
+      if(ids[face] == NONE)
+	ids[face] = next.face_count++;
+      unsigned int global = 2 * handles[side / 2] + side % 2;
+      *next.writable(current,global) = ids[face];
+      relabelled.push_back(global);
+    }
+    for(unsigned int i = 0; i < removed.size(); ++i) {
+      *next.writable(current,2 * removed[i]) = NONE;
+      *next.writable(current,2 * removed[i] + 1) = NONE;
+    }
+  }
+
+  // Indexes the segments of the handles in version as a subdivision of
+  // their own.
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::Level*
+  BasicPolygonalSubdivision<Kernel>::make_level(const Version& version,
+						const vector<unsigned int>&
+						handles) const {
+    Level* level = new Level();
+    try {
+      vector<segment_t> segments(handles.size());
+      map<segment_t, unsigned int, EndPointOrder<segment_t> > by_ends;
+      for(unsigned int i = 0; i < handles.size(); ++i) {
+	segments[i] = segment(version,handles[i]);
+	by_ends[segments[i]] = handles[i];
+      }
+      level->index.addLineSegments(segments);
+      level->index.lock();
+      level->index.freeze();
+      level->handles.resize(level->index._segment_count);
+      for(unsigned int i = 0; i < level->handles.size(); ++i)
+	level->handles[i] = by_ends[level->index._segments[i]];
+    } catch(...) {
+      delete level;
+      throw;
+    }
+    return level;
+  }
+
+  // Indexes the segments added from first_added on with those of the
+  // smallest indexes of next no larger than they are together, leaving
+  // out the removed ones, in place of those indexes.
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::merge_levels(Version& next,
+						  unsigned int first_added)
+    const {
+    if(first_added == next.handle_count)
+      return;
+    vector<unsigned int> handles;
+    for(unsigned int handle = first_added;
+	handle < next.handle_count;
+	++handle)
+      handles.push_back(handle);
+    unsigned int kept = next.levels.size();
+    while(kept > 0 &&
+	  next.levels[kept - 1]->handles.size() <= handles.size()) {
+      const Level& level = *next.levels[--kept];
+      for(unsigned int i = 0; i < level.handles.size(); ++i)
+	if(next.present(level.handles[i]))
+	  handles.push_back(level.handles[i]);
+    }
+
+    Level* level = make_level(next,handles);
+    next.levels.resize(kept);
+    next.levels.push_back(level);
+  }
+
+  // Once the removed segments make up more than a COMPACT_FRACTION of
+  // the entries of next's indexes, indexes its present segments
+  // together in place of them all.  The removals that lead to it number
+  // a fraction of the segments indexed again, so the cost is spread
+  // over them as that of merge_levels() is over the added segments.
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::compact(const Version& current,
+						  Version& next) const {
+    unsigned int indexed = next.own_index ? _segment_count : 0;
+    for(unsigned int i = 0; i < next.levels.size(); ++i)
+      indexed += next.levels[i]->handles.size();
+    unsigned int present = next.handle_count - next.removed_count;
+    if(COMPACT_FRACTION * (indexed - present) <= indexed)
+      return;
+
+    vector<unsigned int> handles;
+    handles.reserve(present);
+    for(unsigned int handle = 0; handle < next.handle_count; ++handle)
+      if(next.present(handle))
+	handles.push_back(handle);
+    vector<Level*> levels;
+    if(!handles.empty())
+      levels.push_back(make_level(next,handles));
+    // those of current are freed with it, once no query reads them
+    for(unsigned int i = 0; i < next.levels.size(); ++i)
+      if(find(current.levels.begin(),current.levels.end(),next.levels[i]) ==
+	 current.levels.end())
+	delete next.levels[i];
+    next.levels.swap(levels);
+    next.own_index = false;
+  }
+
+  // Frees what version holds and kept does not, and then version.  The
+  // pages in _faces are not its own.
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::release(Version* version,
+						  const Version& kept) const {
+    for(unsigned int page = 0; page < version->faces.size(); ++page) {
+      const unsigned int* faces = version->faces[page];
+      if(page * UPDATE_PAGE < 2 * _segment_count &&
+	 faces == _faces + page * UPDATE_PAGE)
+	continue;
+      if(page < kept.faces.size() && faces == kept.faces[page])
+	continue;
+      delete[] faces;
+    }
+    for(unsigned int i = 0; i < version->levels.size(); ++i)
+      if(find(kept.levels.begin(),kept.levels.end(),version->levels[i]) ==
+	 kept.levels.end())
+	delete version->levels[i];
+    delete version;
   }
 
+  // Waits until no query can still read the version before the one just
+  // published.  A query counts itself in under the epoch it read, which
+  // may be stale by the time it does, so the epoch moves on twice, and
+  // each time the queries under the last one are waited for.  Those
+  // coming in after the first move find the new version.
+  template <class Kernel>
+  void BasicPolygonalSubdivision<Kernel>::wait_for_readers() {
+    for(unsigned int round = 0; round < 2; ++round) {
+      unsigned int last = _epoch & 1;
+      _epoch = _epoch + 1;
+      __sync_synchronize();
+      while(_readers[last].count != 0)
+	sched_yield();
+    }
+  }
+
+  // locates p in an updated subdivision, over all its indexes
+  template <class Kernel>
+  typename BasicPolygonalSubdivision<Kernel>::result_t
+  BasicPolygonalSubdivision<Kernel>::locate_updated(const point_t& p,
+						    const Version& version)
+    const {
+    Nearest nearest;
+    if(version.own_index)
+      find_nearest(version,0,p,nearest);
+    for(unsigned int i = 0; i < version.levels.size(); ++i) {
+      const Level& level = *version.levels[i];
+      level.index.find_nearest(version,&level.handles[0],p,nearest);
+    }
+    result_t result = touching(p,
+			       nearest.on_sweep_line,
+			       nearest.vertical,
+			       nearest.above,
+			       nearest.a != 0 ? *nearest.a : handle_t::none(),
+			       nearest.below,
+			       nearest.b != 0 ? *nearest.b : handle_t::none());
+    result.face = nearest.above == NONE ?
+      OUTER_FACE : version.face(2 * nearest.above + 1);
+    return result;
+  }
+
+  // Offers the present segments of this index nearest p, above and
+  // below it in its slab, and notes the vertical one through p.  The
+  // handles of an index of added segments are those of the updated
+  // subdivision, and those of its own without them.
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::find_nearest(const Version& version,
+						  const unsigned int* handles,
+						  const point_t& p,
+						  Nearest& nearest) const {
+    unsigned int index;
+    if(!find_slab(p,index))
+      return;
+    if(p.x == sweep_points[index]) {
+      nearest.on_sweep_line = true;
+      unsigned int vertical = vertical_through(p);
+      if(vertical != NONE &&
+	 version.present(handles != 0 ? handles[vertical] : vertical))
+	nearest.vertical = handles != 0 ? handles[vertical] : vertical;
+    }
+    unsigned int position = slab_index.search(index,p);
+    for(unsigned int i = position; i > 0; --i) {
+      unsigned int own = slab_index.handle(index,i - 1);
+      unsigned int handle = handles != 0 ? handles[own] : own;
+      if(version.present(handle)) {
+	nearest.offer_above(handle,_segments[own]);
+	break;
+      }
+    }
+    for(unsigned int i = position; i < slab_index.size(index); ++i) {
+      unsigned int own = slab_index.handle(index,i);
+      unsigned int handle = handles != 0 ? handles[own] : own;
+      if(version.present(handle)) {
+	nearest.offer_below(handle,_segments[own]);
+	break;
+      }
+    }
+  }
+
+  // Offers the present segment of this index nearest above s where s
+  // starts: right of its left end point, or above the top of a vertical
+  // one.  The segments of the slab through that point lie together
+  // where it would be placed, and s is placed among them by the order
+  // of the slab.  Removed ones may cross s, and are passed over.
+  template <class Kernel>
+  void
+  BasicPolygonalSubdivision<Kernel>::find_nearest_above(const Version&
+							version,
+							const unsigned int*
+							handles,
+							const segment_t& s,
+							Nearest& nearest)
+    const {
+    const point_t& p = s.isVertical() ?
+      s.getTopEndPoint() : s.getLeftEndPoint();
+    unsigned int index;
+    if(!find_slab(p,index))
+      return;
+    unsigned int first = slab_index.search(index,p);
+    unsigned int last = first;
+    while(first > 0 &&
+	  point_t::colinear(_segments[slab_index.handle(index,first - 1)].
+			    getLeftEndPoint(),
+			    _segments[slab_index.handle(index,first - 1)].
+			    getRightEndPoint(),
+			    p))
+      --first;
+    while(last < slab_index.size(index) &&
+	  point_t::colinear(_segments[slab_index.handle(index,last)].
+			    getLeftEndPoint(),
+			    _segments[slab_index.handle(index,last)].
+			    getRightEndPoint(),
+			    p))
+      ++last;
+
+    // a vertical segment is below all those through its top
+    unsigned int position = s.isVertical() ? last : first;
+    if(!s.isVertical())
+      for(unsigned int i = last; i > first; --i) {
+	unsigned int own = slab_index.handle(index,i - 1);
+	if(version.present(handles != 0 ? handles[own] : own) &&
+	   BasicSlabOrder<Kernel>::less(_segments[own],s)) {
+	  position = i;
+	  break;
+	}
+      }
+    for(unsigned int i = position; i > 0; --i) {
+      unsigned int own = slab_index.handle(index,i - 1);
+      unsigned int handle = handles != 0 ? handles[own] : own;
+      if(version.present(handle)) {
+	nearest.offer_above(handle,_segments[own]);
+	return;
+      }
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_POLYGONALSUBDIVISION(K)		\
+  template class BasicPolygonalSubdivision<K>;
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_POLYGONALSUBDIVISION)
 }
@@ -11,7 +11,17 @@
 // PURPOSE: Solves the planar point location problem using a                 //
 //          persistent skiplist.                                             //
 //                                                                           //
-// NOTES:   None.                                                            //
+// NOTES:   BasicPolygonalSubdivision is parameterized by a geometry kernel  //
+//          (see Kernel.hpp); PolygonalSubdivision uses the default kernel.  //
+//                                                                           //
+//          Once locked, the queries are const and may run concurrently.     //
+//          This needs a release (NDEBUG) build, since debug builds of the   //
+//          persistent skip list record the last search path, and with       //
+//          RationalKernel a thread-safe build of LEDA, since copying a      //
+//          rational updates a reference count.                              //
+//                                                                           //
+//          A frozen subdivision may also be changed by update() while the   //
+//          queries run on other threads.                                    //
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 // Public Variable:                     Description:                         //
@@ -24,11 +34,18 @@
 #define POLYGONALSUBDIVISION_HPP
 
 #include <vector>
-#include <set>
 #include "lib/PersistentSkipList/PersistentSkipList.hpp"
 #include "lib/CppLog/CppLog.hpp"
+#include "Arena.hpp"
 #include "Point2D.hpp"
 #include "LineSegment.hpp"
+#include "SegmentHandle.hpp"
+#include "SlabDirectory.hpp"
+#include "SlabIndex.hpp"
+#include "Snapshot.hpp"
+#include "TrapezoidalMap.hpp"
+#include "TriangulationHierarchy.hpp"
+#include "ThreadPool.hpp"
 
 using namespace std;
 using cpplog::CppLog;
@@ -36,50 +53,467 @@ using persistent_skip_list::PersistentSkipList;
 
 namespace geometry {
 
-  class QueryResult {
+  // The segments above and below are handles into the subdivision's
+  // table, which BasicPolygonalSubdivision::segment() dereferences, or
+  // NONE, and the face is the ID of the face containing the point.  So
+  // the result is small and trivially copyable.
+  //
+  // A point on a vertex is given a segment ending there as both above
+  // and below, and vertex set.  Only a point inside a vertical edge has
+  // edge set, with that segment as both above and below.  A point inside
+  // any other edge is located as one just above it, with the edge below.
+  template <class Kernel>
+  class BasicQueryResult {
   public:
+    static const unsigned int NONE = ~0u;
+    static const unsigned int OUTER_FACE = 0;
+
     bool outer;
     bool vertex;
     bool edge;
-    LineSegment above;
-    LineSegment below;
-
-    QueryResult(LineSegment a,
-		LineSegment b,
-		bool o=false,
-		bool v=false,
-		bool e=false)
+    unsigned int above;
+    unsigned int below;
+    unsigned int face;
+
+    BasicQueryResult()
+      : outer(false),
+	vertex(false),
+	edge(false),
+	above(NONE),
+	below(NONE),
+	face(OUTER_FACE)
+    {}
+
+    BasicQueryResult(unsigned int a,
+		     unsigned int b,
+		     bool o=false,
+		     bool v=false,
+		     bool e=false)
       : outer(o),
 	vertex(v),
 	edge(e),
 	above(a),
-	below(b)
+	below(b),
+	face(OUTER_FACE)
     {}
+
+    // the same answer, handles and face alike, as the engines must give
+    bool operator==(const BasicQueryResult& other) const {
+      return outer == other.outer && vertex == other.vertex &&
+	edge == other.edge && above == other.above && below == other.below &&
+	face == other.face;
+    }
+
+    bool operator!=(const BasicQueryResult& other) const {
+      return !operator==(other);
+    }
   };
   
-  class PolygonalSubdivision {
+  // Where a hinted query ended, for the next query of the stream to
+  // start from, and how often the hint answered it.  A new cursor has no
+  // hint.  Each stream needs its own cursor; the counters are its own.
+  template <class Kernel>
+  class BasicQueryCursor {
+  public:
+    // the slab of the last query, the handles of its neighbours there,
+    // and when frozen their position in the slab
+    bool valid;
+    unsigned int slab;
+    unsigned int position;
+    unsigned int above;
+    unsigned int below;
+
+    // queries answered without a search, by searching only the same
+    // slab or the one next to it, and by a full search
+    unsigned long hits;
+    unsigned long near_hits;
+    unsigned long misses;
+
+    BasicQueryCursor()
+      : valid(false),
+	slab(0),
+	position(0),
+	above(BasicQueryResult<Kernel>::NONE),
+	below(BasicQueryResult<Kernel>::NONE),
+	hits(0),
+	near_hits(0),
+	misses(0)
+    {}
+  };
+
+  template <class Kernel>
+  class BandBuildTask;
+
+  template <class Kernel>
+  class BasicPolygonalSubdivision {
   public:
-    PolygonalSubdivision();
-    ~PolygonalSubdivision();
+    typedef Kernel kernel_t;
+    typedef typename Kernel::coord_t coord_t;
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+    typedef BasicQueryResult<Kernel> result_t;
+    typedef BasicQueryCursor<Kernel> cursor_t;
+    typedef BasicSegmentHandle<Kernel> handle_t;
+
+    // the handle of no segment
+    static const unsigned int NONE = ~0u;
+    // the ID of the unbounded face
+    static const unsigned int OUTER_FACE = 0;
+
+    // the structure which answers the queries
+    enum Engine {
+      // slabs between the sweep points, stored in a persistent skip list
+      PERSISTENT_SKIP_LIST,
+      // a randomized incremental trapezoidal map, in expected linear
+      // space; lock(pool) builds it on the calling thread and freeze()
+      // leaves it as it is
+      TRAPEZOIDAL_MAP,
+      // Kirkpatrick's triangulation hierarchy, in linear space and
+      // logarithmic query time in the worst case; it needs an exact
+      // field kernel, and lock(pool) and freeze() treat it as above
+      TRIANGULATION_HIERARCHY
+    };
+
+    BasicPolygonalSubdivision(Engine engine = PERSISTENT_SKIP_LIST);
+    ~BasicPolygonalSubdivision();
+
+    Engine engine() const;
+    // whether lock() can build an engine with this kernel
+    static bool supports(Engine);
+
+    // The segments are added before lock(), after which they throw;
+    // update() changes a locked subdivision.
+    void addLineSegment(segment_t&);
+    void addLineSegment(const segment_t&);
 
-    void addLineSegment(LineSegment&);
-    void addLineSegment(const LineSegment&);
+    // Adds the segments of [begin,end) at once.
+    void addLineSegments(const segment_t* begin, const segment_t* end);
+
+    // Adds the segments and leaves the vector empty.  If no segments
+    // were added before, its storage is taken over rather than copied.
+    void addLineSegments(vector<segment_t>& segments);
+
+    // Reads the segments from a file, mapped into memory and parsed by
+    // BasicSegmentReader (see SegmentReader.hpp), which throws a string
+    // if it cannot be read.  With a pool, the workers parse chunks of
+    // the file at the same time, which needs one segment on each line.
+    void addLineSegments(const char* path);
+    void addLineSegments(const char* path, concurrency::ThreadPool& pool);
 
     void lock();
-    QueryResult locate_point(const Point2D&);
+
+    // As above, with the sweep split into one band of slabs per worker
+    // of the pool.  Each band is built by its own worker, starting from
+    // the segments which span its left boundary.  The queries give the
+    // same results as after a sequential lock().
+    void lock(concurrency::ThreadPool& pool);
+
+    // Optionally, after lock(), copies every version of the sweep into a
+    // flat slab index and frees the skip lists.  Queries then binary
+    // search contiguous arrays instead of walking skip list nodes, and
+    // give the same results.  The index stores each slab in full, so it
+    // needs 4 bytes for every segment crossing every slab.
+    void freeze();
+    bool frozen() const;
+
+    // Once frozen, removes the segments of [remove_begin,remove_end), as
+    // found by their end points, and then adds those of
+    // [insert_begin,insert_end), which must leave segments meeting only
+    // at their end points.  It throws a string if a segment to remove is
+    // not there.
+    //
+    // The index made by freeze() is kept as it is, and the removed
+    // segments in it are passed over.  The added segments are kept in a
+    // few smaller indexes, each locked and frozen from its own segments.
+    // A new one takes over the segments of those no larger than itself,
+    // dropping the removed ones, so that each segment is indexed again a
+    // logarithmic number of times.  Once the removed segments make up a
+    // quarter of what the indexes hold, the present ones are indexed
+    // again together, in place of them all, so that the queries pass
+    // over few.  The faces touching the edit are labelled again, from
+    // the segments around them.  So an update costs about as much as the
+    // segments it adds, those of the indexes it takes over, and those
+    // around the faces it touches, and not the whole subdivision; the
+    // indexing of all the present segments is spread over the removals
+    // which lead to it.
+    //
+    // The queries after it give the results of a subdivision locked
+    // with the segments there, except for handles and face IDs.  An added
+    // segment's handle follows the last one given, and the handle of a
+    // removed one is not given again.  Faces which the edit does not
+    // touch keep their IDs.  Of the faces it makes, those containing a
+    // side which was in a face it touched may take that face's ID, and
+    // the others are numbered after face_count().  A removed segment is
+    // in face NONE on both sides.
+    //
+    // Queries on other threads may run during an update, and find the
+    // subdivision as it was before or after it, never in between.  Once
+    // updated, each query counts itself in and out, and an update waits
+    // for the queries which may still read what it replaced before
+    // freeing it.  Only one update may run at a time.  An updated
+    // subdivision cannot be saved, and its queries are neither hinted
+    // nor interleaved.
+    void update(const segment_t* insert_begin,
+		const segment_t* insert_end,
+		const segment_t* remove_begin,
+		const segment_t* remove_end);
+    bool updated() const;
+
+    // Whether every segment is horizontal or vertical, as found on
+    // lock().  A frozen rectilinear subdivision places its queries by
+    // comparing y coordinates, without orientation tests.
+    bool rectilinear() const;
+
+    // Once frozen, writes the subdivision to a file which load() maps
+    // back in.  The file holds the byte order and layout of this
+    // machine, build and kernel, and a checksum.
+    void save(const char* path) const;
+
+    // Makes a new subdivision, to which no segments have been added,
+    // the one saved in the file, locked and frozen.  With a kernel
+    // whose coordinates are plain old data, the index is searched where
+    // it lies in the mapped file, so that loading costs little more
+    // than the checksum, and processes which load the same file share
+    // its pages.  Other coordinates are parsed.  Clearing verify skips
+    // the checksum.
+    void load(const char* path, bool verify = true);
+
+    // The segment of a handle in a result, which stays valid as long as
+    // the subdivision, or segment_t(0,0,0,0) for NONE.  The handles are
+    // given on lock(), and are the same for subdivisions of the same
+    // segments added in the same order.  Those of removed segments stay
+    // valid.
+    const segment_t& segment(unsigned int handle) const;
+
+    // The arena the structure allocates its small objects from, whose
+    // peak() is the most it has held.  The skip list allocates its own
+    // nodes, so only the trapezoidal map uses it.
+    const memory::Arena& arena() const;
+
+    // The faces of the subdivision, labelled on lock(): the unbounded
+    // face is OUTER_FACE, and the bounded ones are numbered from 1 in
+    // the order of the handles of their first segments.  So the IDs are
+    // the same for subdivisions of the same segments added in the same
+    // order.  A face with holes is one face.  The segments must meet
+    // only at their end points.  Once updated, some IDs below
+    // face_count() may no longer be used.
+    unsigned int face_count() const;
+
+    // The faces on either side of a segment, by handle: above and below
+    // it, or left and right of a vertical one.
+    unsigned int face_above(unsigned int handle) const;
+    unsigned int face_below(unsigned int handle) const;
+
+    // The face of the result is the one containing the point.  A point
+    // on an edge or a vertex is given the face it would be in if moved
+    // right, then up, by less than any gap.  BasicQueryResult tells
+    // which points on edges are flagged.
+    result_t locate_point(const point_t&) const;
+
+    // As above, starting from where the cursor's last query ended, and
+    // leaving the cursor where this one ends.  If the point is still
+    // between the last neighbours in the same slab, no search is needed;
+    // if it moved to a slab next to it, only that slab is searched, from
+    // the last position when frozen.  Otherwise it is a full search.
+    result_t locate_point(const point_t&, cursor_t& cursor) const;
+
+    // Locates each point of [begin,end) and writes its result to the
+    // corresponding position of out.  The queries are processed in
+    // x order, so each slab is found once and its version is searched
+    // by all the queries which fall in it.
+    void locate_points(const point_t* begin,
+		       const point_t* end,
+		       result_t* out) const;
+
+    // As above, with the points split into chunks which the workers of
+    // the pool take, and steal from each other once their own are done.
+    void locate_points(const point_t* begin,
+		       const point_t* end,
+		       result_t* out,
+		       concurrency::ThreadPool& pool) const;
+
+    // Locates the points in the order given, group of them at a time.
+    // When frozen, the searches of a group advance together, each step
+    // prefetching the next probe of every search before comparing any,
+    // so that their cache misses overlap.  Otherwise, or once updated,
+    // the points are located one at a time.  The results are those of
+    // locate_point.
+    void locate_points_interleaved(const point_t* begin,
+				   const point_t* end,
+				   result_t* out,
+				   unsigned int group) const;
+
+    // Locates the points without locking: a single sweep keeps only the
+    // segments crossing the present slab, in a balanced tree, and
+    // answers the queries falling in it, so it needs linear space.  The
+    // results are those of locate_point after lock(), for any engine.
+    // The segments added so far are used up, leaving the subdivision as
+    // if new.  It throws if the subdivision is locked.
+    void locate_points_offline(const point_t* begin,
+			       const point_t* end,
+			       result_t* out);
     
   private:
-    vector< LineSegment > line_segments_left;
-    map< coord_t, vector<LineSegment> > vertical_lines;
-    map< coord_t, vector<LineSegment> > line_segments_right;
-    set< coord_t > x_coords;
+    friend class BandBuildTask<Kernel>;
+
+    // Where the sweep changes: a segment is removed or inserted at x, or
+    // a vertical segment lies there.  The events are sorted by x, the
+    // removals first, and refer to segments by handle.
+    struct SweepEvent {
+      enum Kind { REMOVE, INSERT, VERTICAL };
+
+      coord_t x;
+      unsigned int kind;
+      unsigned int segment;
+
+      SweepEvent() : x(), kind(REMOVE), segment(0) {}
+      SweepEvent(const coord_t& at, unsigned int k, unsigned int s)
+	: x(at), kind(k), segment(s)
+      {}
+
+      bool operator<(const SweepEvent& other) const {
+	if(x < other.x)
+	  return true;
+	if(other.x < x)
+	  return false;
+	return kind < other.kind ||
+	  (kind == other.kind && segment < other.segment);
+      }
+    };
+
+    void sort_events(vector<SweepEvent>& events);
+    void label_faces(const vector<SweepEvent>& events);
+    void build(unsigned int band_count, concurrency::ThreadPool* pool);
+    void build_band(unsigned int band, const vector<SweepEvent>& events);
+    PersistentSkipList< handle_t >& version(unsigned int index,
+					    int& time) const;
+    void neighbours(unsigned int index,
+		    const point_t& p,
+		    unsigned int& above,
+		    unsigned int& below) const;
+
+    void check_queryable() const;
+    bool find_slab(const point_t&, unsigned int& index) const;
+    bool in_slab(const point_t&, unsigned int index) const;
+    void locate_in_slab(const point_t& p, cursor_t& cursor) const;
+    result_t classify(const point_t&,
+		      unsigned int index,
+		      unsigned int above,
+		      unsigned int below) const;
+    result_t feature(const point_t&,
+		     unsigned int index,
+		     unsigned int above,
+		     unsigned int below) const;
+    void use_table(const segment_t* segments,
+		   unsigned int count,
+		   unsigned int verticals,
+		   bool rectilinear);
+    unsigned int vertical_through(const point_t&) const;
+    static result_t touching(const point_t& p,
+			     bool on_sweep_line,
+			     unsigned int vertical,
+			     unsigned int above,
+			     const segment_t& a,
+			     unsigned int below,
+			     const segment_t& b);
+
+    // what update() makes, defined in PolygonalSubdivision.cpp
+    struct Version;
+    struct Level;
+    struct UpdateState;
+    struct Nearest;
+    class VersionReader;
+    friend class VersionReader;
+
+    void check_unlocked() const;
+    result_t locate_updated(const point_t&, const Version&) const;
+    void find_nearest(const Version&,
+		      const unsigned int* handles,
+		      const point_t& p,
+		      Nearest& nearest) const;
+    void find_nearest_above(const Version&,
+			    const unsigned int* handles,
+			    const segment_t& s,
+			    Nearest& nearest) const;
+    const segment_t& segment(const Version&, unsigned int handle) const;
+    unsigned int find_handle(const Version&, const segment_t& s) const;
+    Version* first_version();
+    void touched_faces(const Version&,
+		       const segment_t* insert_begin,
+		       const segment_t* insert_end,
+		       const vector<unsigned int>& removed,
+		       vector<unsigned int>& touched) const;
+    void relabel(const Version& current,
+		 Version& next,
+		 const vector<unsigned int>& touched,
+		 const vector<unsigned int>& removed,
+		 vector<unsigned int>& relabelled) const;
+    Level* make_level(const Version&,
+		      const vector<unsigned int>& handles) const;
+    void merge_levels(Version& next, unsigned int first_added) const;
+    void compact(const Version& current, Version& next) const;
+    void release(Version* version, const Version& kept) const;
+    void wait_for_readers();
+
+    // not copyable
+    BasicPolygonalSubdivision(const BasicPolygonalSubdivision&);
+    BasicPolygonalSubdivision& operator=(const BasicPolygonalSubdivision&);
+
+    vector< segment_t > line_segments_left;
+    // Each segment is stored once, in the table, and referred to by its
+    // index there: the non-vertical segments by left end point, then the
+    // vertical ones by x and from the bottom.  It lies in segment_table,
+    // or in the file a snapshot was loaded from.
+    vector< segment_t > segment_table;
+    const segment_t* _segments;
+    unsigned int _segment_count;
+    unsigned int _non_vertical;
+    bool _rectilinear;
+    // The face above and below each segment, by handle, in pairs.  It
+    // lies in face_table, or in the file a snapshot was loaded from.
+    vector< unsigned int > face_table;
+    const unsigned int* _faces;
+    unsigned int _face_count;
     vector< coord_t > sweep_points;
-    PersistentSkipList< LineSegment > psl;
+    // finds the slab of a query without a binary search
+    BasicSlabDirectory< Kernel > slab_directory;
+    vector< unsigned int > slab_sizes;
+    // The slabs are split into bands of consecutive slabs, each with its
+    // own skip list whose times count from the first slab of the band.
+    // The skip list's searches are not declared const, but do not
+    // change it once it is locked.
+    vector< unsigned int > band_starts;
+    mutable vector< PersistentSkipList< handle_t >* > bands;
+    BasicSlabIndex< Kernel > slab_index;
+    // the file a loaded index lies in
+    SnapshotReader snapshot;
+    // holds the small objects of the structure, which are freed with it
+    // at once
+    memory::Arena _arena;
+    BasicTrapezoidalMap< Kernel > trapezoidal_map;
+    BasicTriangulationHierarchy< Kernel > triangulation_hierarchy;
+
+    // What the queries of an updated subdivision read, or 0 until then,
+    // and what only update() reads.  The queries under way are counted
+    // under each of two epochs, each count on its own cache line.
+    struct ReaderCount {
+      volatile unsigned long count;
+      char padding[64 - sizeof(unsigned long)];
+    };
+    Version* volatile _version;
+    UpdateState* _updates;
+    mutable ReaderCount _readers[2];
+    volatile unsigned int _epoch;
     
+    Engine _engine;
     bool _locked;
     CppLog _log;
   };
-  
+
+  // The subdivision of the default kernel
+  typedef BasicQueryResult<DefaultKernel> QueryResult;
+  typedef BasicQueryCursor<DefaultKernel> QueryCursor;
+  typedef BasicPolygonalSubdivision<DefaultKernel> PolygonalSubdivision;
 }
 
 #endif
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SegmentHandle.hpp                                                //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: A 32-bit reference to a segment of a subdivision's table, which  //
+//          the persistent skip list stores in place of the segment.         //
+//                                                                           //
+// NOTES:   The skip list orders its elements by their operator<, which      //
+//          cannot be given a table.  So the table, and the query point      //
+//          searched for, are those of the calling thread, set by a Scope    //
+//          around every use of the skip list.  Scopes nest, so that one     //
+//          subdivision may be searched while another is built on the same   //
+//          thread.                                                          //
+//                                                                           //
+//          NONE stands for segment_t(0,0,0,0), which is what the skip list  //
+//          gives where there is no segment, and KEY for the query point,    //
+//          which is compared as the segment (p,p) without being made one.   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// Scope(table,key)                     uses table and key on this thread    //
+//                                      until the scope is left              //
+// get()                                the segment referred to, if not KEY  //
+// operator<, operator==                compare the segments in slab order   //
+//                                      (see SlabOrder.hpp); handles of the  //
+//                                      same index are equal                 //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef SEGMENTHANDLE_HPP
+#define SEGMENTHANDLE_HPP
+
+#include <stdint.h>
+#include <ostream>
+#include "Point2D.hpp"
+#include "LineSegment.hpp"
+#include "SlabOrder.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicSegmentHandle {
+  public:
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    static const uint32_t NONE = ~0u;
+    static const uint32_t KEY = ~0u - 1;
+
+    class Scope;
+    friend class Scope;
+
+    class Scope {
+    public:
+      Scope(const segment_t* table, const point_t* key = 0)
+	: _table(BasicSegmentHandle::_table),
+	  _key(BasicSegmentHandle::_key)
+      {
+	BasicSegmentHandle::_table = table;
+	BasicSegmentHandle::_key = key;
+      }
+
+      ~Scope() {
+	BasicSegmentHandle::_table = _table;
+	BasicSegmentHandle::_key = _key;
+      }
+
+    private:
+      const segment_t* _table;
+      const point_t* _key;
+    };
+
+    BasicSegmentHandle() : index(NONE) {}
+    explicit BasicSegmentHandle(uint32_t i) : index(i) {}
+
+    const segment_t& get() const {
+      if(index == NONE)
+	return none();
+      return _table[index];
+    }
+
+    bool operator<(const BasicSegmentHandle& other) const {
+      if(index == other.index)
+	return false;
+      if(index == KEY)
+	return BasicSlabOrder<Kernel>::less(*_key,other.get());
+      if(other.index == KEY)
+	return BasicSlabOrder<Kernel>::less(get(),*_key);
+      return BasicSlabOrder<Kernel>::less(get(),other.get());
+    }
+
+    bool operator==(const BasicSegmentHandle& other) const {
+      return index == other.index;
+    }
+
+    bool operator!=(const BasicSegmentHandle& other) const {
+      return index != other.index;
+    }
+
+    static const segment_t& none() {
+      static const segment_t segment(0,0,0,0);
+      return segment;
+    }
+
+    uint32_t index;
+
+  private:
+    static __thread const segment_t* _table;
+    static __thread const point_t* _key;
+  };
+
+  template <class Kernel>
+  __thread const typename BasicSegmentHandle<Kernel>::segment_t*
+  BasicSegmentHandle<Kernel>::_table = 0;
+
+  template <class Kernel>
+  __thread const typename BasicSegmentHandle<Kernel>::point_t*
+  BasicSegmentHandle<Kernel>::_key = 0;
+
+  template <class Kernel>
+  ostream& operator<<(ostream& os, const BasicSegmentHandle<Kernel>& handle) {
+    if(handle.index == BasicSegmentHandle<Kernel>::KEY)
+      return os << "key";
+    return os << handle.get();
+  }
+}
+
+#endif
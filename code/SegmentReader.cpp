@@ -0,0 +1,375 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SegmentReader.cpp                                                //
+//                                                                           //
+// MODULE:  Input/Output                                                     //
+//                                                                           //
+// NOTES:   A decimal whose digits and power of ten are both exact doubles   //
+//          is converted with one multiplication or division, which rounds   //
+//          correctly (Clinger's fast path); any other is left to strtod.    //
+//          Rationals are built 9 digits at a time in machine arithmetic.    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include "SegmentReader.hpp"
+#include "MappedFile.hpp"
+
+#ifndef GEOMETRY_NO_LEDA
+using leda::integer;
+#endif
+
+namespace geometry {
+  /////////////////////////////////////////////////////////////////////////////
+  // Numerals                                                                //
+  /////////////////////////////////////////////////////////////////////////////
+  // A coordinate as it is written: the digits of the numerator, with at
+  // most one decimal point among them, times a power of ten, over the
+  // digits of the denominator, if there is one
+  struct Numeral {
+    // the whole numeral, and the numerator with its exponent
+    const char* begin;
+    const char* end;
+    const char* numerator_end;
+    bool negative;
+    const char* digits;
+    const char* digits_end;
+    int exponent;
+    const char* denominator;
+    const char* denominator_end;
+  };
+
+  // the largest power of ten a numeral may be scaled by
+  static const int MAX_EXPONENT = 9999;
+
+  static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+      c == '\v' || c == '\f';
+  }
+
+  static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  static string failure(const char* reason, const Numeral& n) {
+    return string(reason) + string(n.begin,n.end);
+  }
+
+  // scans the numeral at [begin,end), which holds no white space
+  static void scan(const char* begin, const char* end, Numeral& n) {
+    n.begin = begin;
+    n.end = end;
+    n.negative = false;
+    n.exponent = 0;
+    n.denominator = n.denominator_end = 0;
+    const char* p = begin;
+    if(p != end && (*p == '-' || *p == '+')) {
+      n.negative = *p == '-';
+      ++p;
+    }
+    n.digits = p;
+    unsigned int digits = 0;
+    bool point = false;
+    for(; p != end; ++p) {
+      if(isDigit(*p)) {
+	++digits;
+	if(point)
+	  --n.exponent;
+      } else if(*p == '.' && !point) {
+	point = true;
+      } else {
+	break;
+      }
+    }
+    n.digits_end = p;
+    if(digits == 0)
+      throw failure("Malformed coordinate: ",n);
+    if(p != end && (*p == 'e' || *p == 'E')) {
+      ++p;
+      bool negative = false;
+      if(p != end && (*p == '-' || *p == '+')) {
+	negative = *p == '-';
+	++p;
+      }
+      if(p == end || !isDigit(*p))
+	throw failure("Malformed coordinate: ",n);
+      int exponent = 0;
+      for(; p != end && isDigit(*p); ++p) {
+	exponent = exponent * 10 + (*p - '0');
+	if(exponent > MAX_EXPONENT)
+	  throw failure("Coordinate out of range: ",n);
+      }
+      n.exponent += negative ? -exponent : exponent;
+    }
+    n.numerator_end = p;
+    if(p != end && *p == '/') {
+      n.denominator = ++p;
+      while(p != end && isDigit(*p))
+	++p;
+      n.denominator_end = p;
+      if(n.denominator == p)
+	throw failure("Malformed coordinate: ",n);
+      while(n.denominator != p && *n.denominator == '0')
+	++n.denominator;
+      if(n.denominator == p)
+	throw failure("Zero denominator: ",n);
+    }
+    if(p != end)
+      throw failure("Malformed coordinate: ",n);
+  }
+
+  // the value of the digits at [begin,end), skipping a decimal point,
+  // unless it does not fit in 64 bits
+  static bool smallValue(const char* begin, const char* end, uint64_t& value) {
+    const uint64_t most = ~uint64_t(0);
+    value = 0;
+    for(; begin != end; ++begin) {
+      if(*begin == '.')
+	continue;
+      unsigned int digit = *begin - '0';
+      if(value > (most - digit) / 10)
+	return false;
+      value = value * 10 + digit;
+    }
+    return true;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Conversions, by coordinate type                                         //
+  /////////////////////////////////////////////////////////////////////////////
+  static void convert(const Numeral& n, int64_t& out) {
+    uint64_t value;
+    if(!smallValue(n.digits,n.digits_end,value))
+      throw failure("Coordinate out of range: ",n);
+    int exponent = value == 0 ? 0 : n.exponent;
+    for(; exponent < 0 && value % 10 == 0; ++exponent)
+      value /= 10;
+    if(exponent < 0)
+      throw failure("Coordinate is not an integer: ",n);
+    for(; exponent > 0; --exponent) {
+      if(value > ~uint64_t(0) / 10)
+	throw failure("Coordinate out of range: ",n);
+      value *= 10;
+    }
+    if(n.denominator) {
+      uint64_t denominator;
+      if(!smallValue(n.denominator,n.denominator_end,denominator))
+	throw failure("Coordinate out of range: ",n);
+      if(value % denominator != 0)
+	throw failure("Coordinate is not an integer: ",n);
+      value /= denominator;
+    }
+    const uint64_t most = uint64_t(1) << 63;
+    if(value > (n.negative ? most : most - 1))
+      throw failure("Coordinate out of range: ",n);
+    out = n.negative ? -int64_t(value - 1) - 1 : int64_t(value);
+  }
+
+  static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  // the digits at [begin,end) times 10^exponent, rounded to the nearest
+  // double; text is the same number as strtod reads it
+  static double decimal(const char* begin, const char* end, int exponent,
+			const char* text, const char* text_end) {
+    uint64_t value;
+    if(smallValue(begin,end,value) && value <= uint64_t(1) << 53 &&
+       exponent >= -22 && exponent <= 22)
+      return exponent < 0 ? double(value) / POWERS_OF_TEN[-exponent]
+	: double(value) * POWERS_OF_TEN[exponent];
+    return strtod(string(text,text_end).c_str(),0);
+  }
+
+  static void convert(const Numeral& n, double& out) {
+    out = decimal(n.digits,n.digits_end,n.exponent,n.digits,n.numerator_end);
+    if(n.denominator)
+      out /= decimal(n.denominator,n.denominator_end,0,
+		     n.denominator,n.denominator_end);
+    if(n.negative)
+      out = -out;
+  }
+
+#ifndef GEOMETRY_NO_LEDA
+  // the integer of the digits at [begin,end), skipping a decimal point
+  static integer bigValue(const char* begin, const char* end) {
+    integer value(0L);
+    long chunk = 0;
+    long scale = 1;
+    for(; begin != end; ++begin) {
+      if(*begin == '.')
+	continue;
+      chunk = chunk * 10 + (*begin - '0');
+      scale *= 10;
+      if(scale == 1000000000L) {
+	value = value * integer(scale) + integer(chunk);
+	chunk = 0;
+	scale = 1;
+      }
+    }
+    return value * integer(scale) + integer(chunk);
+  }
+
+  static integer powerOfTen(int exponent) {
+    integer value(1L);
+    for(; exponent >= 9; exponent -= 9)
+      value = value * integer(1000000000L);
+    long rest = 1;
+    for(; exponent > 0; --exponent)
+      rest *= 10;
+    return value * integer(rest);
+  }
+
+  static void convert(const Numeral& n, rational& out) {
+    uint64_t value;
+    if(!n.denominator && n.exponent == 0 &&
+       smallValue(n.digits,n.digits_end,value) &&
+       value < uint64_t(1000000000)) {
+      // most coordinates are small integers
+      long small = long(value);
+      out = rational(integer(n.negative ? -small : small),integer(1L));
+      return;
+    }
+    integer numerator = bigValue(n.digits,n.digits_end);
+    integer denominator = n.denominator ?
+      bigValue(n.denominator,n.denominator_end) : integer(1L);
+    if(n.exponent > 0)
+      numerator = numerator * powerOfTen(n.exponent);
+    else if(n.exponent < 0)
+      denominator = denominator * powerOfTen(-n.exponent);
+    if(n.negative)
+      numerator = -numerator;
+    out = rational(numerator,denominator);
+  }
+#endif
+
+  /////////////////////////////////////////////////////////////////////////////
+  // ReadTask                                                                //
+  //                                                                         //
+  // Parses the chunks of a file, each into its own vector, so that they    //
+  // can be joined in order.                                                 //
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  class ReadTask : public concurrency::ThreadPool::Task {
+  public:
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    ReadTask(const vector<const char*>& starts, unsigned int workers)
+      : parts(starts.size() - 1),
+	errors(starts.size() - 1),
+	_starts(starts),
+	_queue(starts.size() - 1,workers,1)
+    {}
+
+    void run(unsigned int worker) {
+      unsigned int begin, end;
+      while(_queue.next(worker,begin,end)) {
+	for(unsigned int chunk = begin; chunk < end; ++chunk) {
+	  // keep the error of each chunk, so that the first in the file
+	  // is the one reported, whichever worker met it first
+	  try {
+	    BasicSegmentReader<Kernel>::read(_starts[chunk],_starts[chunk + 1],
+					      parts[chunk]);
+	  } catch(string str) {
+	    errors[chunk] = str;
+	  }
+	}
+      }
+    }
+
+    vector< vector<segment_t> > parts;
+    vector<string> errors;
+
+  private:
+    const vector<const char*>& _starts;
+    concurrency::WorkQueue _queue;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // BasicSegmentReader implementation                                       //
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  void BasicSegmentReader<Kernel>::read(const char* begin,
+					const char* end,
+					vector<segment_t>& out) {
+    // most files hold a segment on each line
+    out.reserve(out.size() + count(begin,end,'\n') + 1);
+    coord_t coordinates[4];
+    unsigned int filled = 0;
+    Numeral numeral;
+    const char* p = begin;
+    for(;;) {
+      while(p != end && isSpace(*p))
+	++p;
+      if(p == end)
+	break;
+      const char* token = p;
+      while(p != end && !isSpace(*p))
+	++p;
+      scan(token,p,numeral);
+      convert(numeral,coordinates[filled]);
+      if(++filled == 4) {
+	out.push_back(segment_t(point_t(coordinates[0],coordinates[1]),
+				point_t(coordinates[2],coordinates[3])));
+	filled = 0;
+      }
+    }
+    if(filled != 0)
+      throw string("Incomplete line segment at the end of the input");
+  }
+
+  template <class Kernel>
+  void BasicSegmentReader<Kernel>::read(const char* path,
+					vector<segment_t>& out,
+					concurrency::ThreadPool* pool) {
+    io::MappedFile file;
+    file.open(path);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    if(!pool || pool->size() == 1 || file.size() == 0) {
+      read(begin,end,out);
+      return;
+    }
+
+    // cut the file into chunks of about the same size, at line breaks
+    unsigned int chunks = pool->size() * CHUNKS_PER_WORKER;
+    vector<const char*> starts(1,begin);
+    for(unsigned int i = 1; i < chunks; ++i) {
+      const char* cut = max(begin + file.size() / chunks * i,starts.back());
+      const void* line = memchr(cut,'\n',end - cut);
+      starts.push_back(line ? static_cast<const char*>(line) + 1 : end);
+    }
+    starts.push_back(end);
+
+    ReadTask<Kernel> task(starts,pool->size());
+    pool->run(task);
+    for(unsigned int i = 0; i < task.errors.size(); ++i)
+      if(!task.errors[i].empty())
+	throw task.errors[i] + " in " + path;
+
+    size_t total = out.size();
+    for(unsigned int i = 0; i < task.parts.size(); ++i)
+      total += task.parts[i].size();
+    out.reserve(total);
+    for(unsigned int i = 0; i < task.parts.size(); ++i) {
+      out.insert(out.end(),task.parts[i].begin(),task.parts[i].end());
+      vector<segment_t>().swap(task.parts[i]);
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_SEGMENTREADER(K)		\
+  template class BasicSegmentReader<K>;
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_SEGMENTREADER)
+}
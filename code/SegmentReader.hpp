@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SegmentReader.hpp                                                //
+//                                                                           //
+// MODULE:  Input/Output                                                     //
+//                                                                           //
+// PURPOSE: Reads line segments from text, as operator>> would, without      //
+//          going through iostreams.                                         //
+//                                                                           //
+// NOTES:   Each segment is four coordinates, ax ay bx by, separated by      //
+//          white space.  A coordinate is an integer or a decimal, with an   //
+//          optional exponent, and optionally over a positive integer, as    //
+//          in p/q.  It must have an exact value in the kernel's             //
+//          coordinates, except with DoubleKernel, which rounds to a double. //
+//                                                                           //
+//          A file read with a pool is split into chunks at line breaks,     //
+//          which the workers parse at the same time, so each segment must   //
+//          be on a line of its own.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// read(begin,end,out)                  appends the segments of the text at  //
+//                                      [begin,end) to out, throwing a       //
+//                                      string if it is malformed            //
+// read(path,out,pool)                  as above, for the text of a file,    //
+//                                      in chunks on the pool if not 0       //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef SEGMENTREADER_HPP
+#define SEGMENTREADER_HPP
+
+#include <vector>
+#include "LineSegment.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicSegmentReader {
+  public:
+    typedef typename Kernel::coord_t coord_t;
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    static void read(const char* begin,
+		     const char* end,
+		     vector<segment_t>& out);
+    static void read(const char* path,
+		     vector<segment_t>& out,
+		     concurrency::ThreadPool* pool = 0);
+
+  private:
+    // the number of chunks per worker, so that uneven lines balance out
+    static const unsigned int CHUNKS_PER_WORKER = 8;
+  };
+
+  // The reader of the default kernel
+  typedef BasicSegmentReader<DefaultKernel> SegmentReader;
+}
+
+#endif
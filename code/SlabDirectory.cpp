@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SlabDirectory.cpp                                                //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// NOTES:   The guess is monotone in x within a bucket, and the answer is a  //
+//          step at each point, so the error over a whole bucket is largest  //
+//          just before or at one of its points; those are measured.         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include "SlabDirectory.hpp"
+
+namespace geometry {
+  /////////////////////////////////////////////////////////////////////////////
+  // BasicSlabDirectory implementation                                       //
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  BasicSlabDirectory<Kernel>::BasicSlabDirectory()
+    : _points(0),
+      _count(0),
+      _buckets(0),
+      _low(0),
+      _scale(0),
+      _first(),
+      _error()
+  {
+  }
+
+  template <class Kernel>
+  void BasicSlabDirectory<Kernel>::build(const coord_t* points,
+					 unsigned int count) {
+    _points = points;
+    _count = count;
+    // one bucket per point, so that evenly spread points are guessed
+    // within one or two
+    _buckets = count;
+    _first.clear();
+    _error.clear();
+    if(count == 0)
+      return;
+
+    _low = Kernel::to_double(points[0]);
+    double high = Kernel::to_double(points[count - 1]);
+    _scale = _low < high ? _buckets / (high - _low) : 0;
+
+    // the doubles of rationals may be out of order, so a bucket starts
+    // at the first point of that bucket or a later one
+    _first.resize(_buckets + 1);
+    unsigned int next = 0;
+    for(unsigned int i = 0; i < count; ++i) {
+      double fraction;
+      unsigned int b = bucket(Kernel::to_double(points[i]),fraction);
+      for(; next <= b; ++next)
+	_first[next] = i;
+    }
+    for(; next <= _buckets; ++next)
+      _first[next] = count;
+
+    // Between point i - 1 and point i the answer is i, and at point i
+    // it becomes i + 1.
+    _error.assign(_buckets,0);
+    for(unsigned int i = 0; i < count; ++i) {
+      double fraction;
+      unsigned int b = bucket(Kernel::to_double(points[i]),fraction);
+      unsigned int g = guess(b,fraction);
+      unsigned int error = g > i ? g - i : i + 1 - g;
+      if(_error[b] < error)
+	_error[b] = error;
+    }
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabDirectory<Kernel>::bucket(double d,
+						  double& fraction) const {
+    double t = (d - _low) * _scale;
+    // also taken by NaN, left of every point
+    if(!(t > 0)) {
+      fraction = 0;
+      return 0;
+    }
+    if(!(t < _buckets)) {
+      fraction = 1;
+      return _buckets - 1;
+    }
+    unsigned int b = (unsigned int)t;
+    fraction = t - b;
+    return b;
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabDirectory<Kernel>::guess(unsigned int bucket,
+						 double fraction) const {
+    unsigned int first = _first[bucket];
+    return first + (unsigned int)(fraction * (_first[bucket + 1] - first));
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabDirectory<Kernel>::find(const coord_t& x) const {
+    if(_count == 0)
+      return 0;
+    double fraction;
+    unsigned int b = bucket(Kernel::to_double(x),fraction);
+    unsigned int g = guess(b,fraction);
+    unsigned int error = _error[b];
+    unsigned int first = _first[b];
+    unsigned int last = _first[b + 1];
+    unsigned int low = g > first + error ? g - error : first;
+    unsigned int high = g + error < last ? g + error : last;
+    unsigned int i = int(upper_bound(_points + low,_points + high,x) - _points);
+
+    // the doubles were wrong, so search everything
+    if((i > 0 && x < _points[i - 1]) || (i < _count && !(x < _points[i])))
+      i = int(upper_bound(_points,_points + _count,x) - _points);
+    return i;
+  }
+
+  template <class Kernel>
+  void BasicSlabDirectory<Kernel>::prefetch(const coord_t& x) const {
+    if(_count == 0)
+      return;
+    double fraction;
+    unsigned int b = bucket(Kernel::to_double(x),fraction);
+    __builtin_prefetch(&_first[b]);
+    __builtin_prefetch(&_error[b]);
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabDirectory<Kernel>::buckets() const {
+    return _buckets;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_SLABDIRECTORY(K)		\
+  template class BasicSlabDirectory<K>;
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_SLABDIRECTORY)
+}
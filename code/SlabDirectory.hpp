@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SlabDirectory.hpp                                                //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: Finds the slab of a query x coordinate among the sorted sweep    //
+//          points in a few memory accesses, instead of a binary search.     //
+//                                                                           //
+// NOTES:   The range of the sweep points, approximated by doubles, is cut   //
+//          into equal buckets, each holding the index of its first point.   //
+//          Within a bucket the index of x is interpolated, and the largest  //
+//          error of the interpolation over the bucket, found when it is     //
+//          built, bounds a binary search around the guess.  The answer is   //
+//          then checked against the exact coordinates, and where the        //
+//          doubles misorder them, as they may with rationals, a binary      //
+//          search over all the points gives it instead.                     //
+//                                                                           //
+//          Skewed coordinates crowd into few buckets, where the error and   //
+//          so the search grow, but never past that of the binary search.    //
+//                                                                           //
+//          The points are not copied, and must outlive the directory.       //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// build(points,count)                  indexes the sorted, distinct points  //
+// find(x)                              the number of points not greater     //
+//                                      than x, as upper_bound gives it      //
+// prefetch(x)                          starts loading the bucket of x, for  //
+//                                      a find(x) soon after                 //
+// buckets()                            the number of buckets                //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef SLABDIRECTORY_HPP
+#define SLABDIRECTORY_HPP
+
+#include <vector>
+#include "Kernel.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicSlabDirectory {
+  public:
+    typedef typename Kernel::coord_t coord_t;
+
+    BasicSlabDirectory();
+
+    void build(const coord_t* points, unsigned int count);
+    unsigned int find(const coord_t& x) const;
+    void prefetch(const coord_t& x) const;
+    unsigned int buckets() const;
+
+  private:
+    // the bucket of d, and the position of d within it, in [0,1]
+    unsigned int bucket(double d, double& fraction) const;
+    // the guess at the index of a coordinate with the given bucket and
+    // position
+    unsigned int guess(unsigned int bucket, double fraction) const;
+
+    const coord_t* _points;
+    unsigned int _count;
+    unsigned int _buckets;
+    double _low;
+    double _scale;
+    // the index of the first point of each bucket, and one past the end
+    vector<unsigned int> _first;
+    // the largest error of guess() for any coordinate in each bucket
+    vector<unsigned int> _error;
+  };
+}
+
+#endif
@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SlabIndex.cpp                                                    //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// NOTES:   The runs are ordered like the skip list, in slab order (see      //
+//          SlabOrder.hpp), so a search gives the same neighbours as         //
+//          PersistentSkipList::find.                                        //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SlabIndex.hpp"
+
+namespace geometry {
+  /////////////////////////////////////////////////////////////////////////////
+  // BasicSlabIndex implementation                                           //
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  BasicSlabIndex<Kernel>::BasicSlabIndex()
+    : _offset_storage(),
+      _run_storage(),
+      _segments(0),
+      _offsets(0),
+      _runs(0),
+      _segment_count(0),
+      _slab_count(0),
+      _rectilinear(false)
+  {
+  }
+
+  template <class Kernel>
+  void BasicSlabIndex<Kernel>::assign(const segment_t* segments,
+				      unsigned int segment_count,
+				      vector<unsigned int>& offsets,
+				      vector<unsigned int>& runs,
+				      bool rectilinear) {
+    _offset_storage.swap(offsets);
+    _run_storage.swap(runs);
+    vector<unsigned int>().swap(offsets);
+    vector<unsigned int>().swap(runs);
+
+    _segments = segments;
+    _offsets = _offset_storage.empty() ? 0 : &_offset_storage[0];
+    _runs = _run_storage.empty() ? 0 : &_run_storage[0];
+    _segment_count = segment_count;
+    _slab_count = _offset_storage.empty() ? 0 : _offset_storage.size() - 1;
+    _rectilinear = rectilinear;
+  }
+
+  template <class Kernel>
+  void BasicSlabIndex<Kernel>::view(const segment_t* segments,
+				    unsigned int segment_count,
+				    const unsigned int* offsets,
+				    const unsigned int* runs,
+				    unsigned int slab_count,
+				    bool rectilinear) {
+    vector<unsigned int>().swap(_offset_storage);
+    vector<unsigned int>().swap(_run_storage);
+
+    _segments = segments;
+    _offsets = offsets;
+    _runs = runs;
+    _segment_count = segment_count;
+    _slab_count = slab_count;
+    _rectilinear = rectilinear;
+  }
+
+  template <class Kernel>
+  bool BasicSlabIndex<Kernel>::empty() const {
+    return _offsets == 0;
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabIndex<Kernel>::size(unsigned int slab) const {
+    return _offsets[slab + 1] - _offsets[slab];
+  }
+
+  template <class Kernel>
+  const typename BasicSlabIndex<Kernel>::segment_t*
+  BasicSlabIndex<Kernel>::segments() const {
+    return _segments;
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabIndex<Kernel>::segment_count() const {
+    return _segment_count;
+  }
+
+  template <class Kernel>
+  const unsigned int* BasicSlabIndex<Kernel>::offsets() const {
+    return _offsets;
+  }
+
+  template <class Kernel>
+  const unsigned int* BasicSlabIndex<Kernel>::runs() const {
+    return _runs;
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabIndex<Kernel>::slab_count() const {
+    return _slab_count;
+  }
+
+  template <class Kernel>
+  template <class Order>
+  unsigned int BasicSlabIndex<Kernel>::bisect(const unsigned int* run,
+					      const point_t& p,
+					      unsigned int low,
+					      unsigned int high) const {
+    while(low < high) {
+      unsigned int middle = low + (high - low) / 2;
+      if(Order::less(p,_segments[run[middle]]))
+	high = middle;
+      else
+	low = middle + 1;
+    }
+    return low;
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabIndex<Kernel>::search(unsigned int slab,
+					      const point_t& p) const {
+    const unsigned int* run = _runs + _offsets[slab];
+    if(_rectilinear)
+      return bisect< BasicRectilinearOrder<Kernel> >(run,p,0,size(slab));
+    return bisect< BasicSlabOrder<Kernel> >(run,p,0,size(slab));
+  }
+
+  template <class Kernel>
+  unsigned int BasicSlabIndex<Kernel>::search(unsigned int slab,
+					      const point_t& p,
+					      unsigned int hint) const {
+    const unsigned int* run = _runs + _offsets[slab];
+    unsigned int n = size(slab);
+    if(hint > n)
+      hint = n;
+    if(_rectilinear)
+      return gallop< BasicRectilinearOrder<Kernel> >(run,n,p,hint);
+    return gallop< BasicSlabOrder<Kernel> >(run,n,p,hint);
+  }
+
+  template <class Kernel>
+  template <class Order>
+  unsigned int BasicSlabIndex<Kernel>::gallop(const unsigned int* run,
+					      unsigned int n,
+					      const point_t& p,
+					      unsigned int hint) const {
+    // double the step until the answer is passed, so a search costs
+    // about twice the log of its distance from the hint
+    unsigned int step = 1;
+    if(hint < n && !Order::less(p,_segments[run[hint]])) {
+      // the answer is below the hint
+      unsigned int low = hint + 1;
+      while(low + step - 1 < n &&
+	    !Order::less(p,_segments[run[low + step - 1]])) {
+	low += step;
+	step *= 2;
+      }
+      unsigned int high = low + step - 1 < n ? low + step - 1 : n;
+      return bisect<Order>(run,p,low,high);
+    }
+    // the answer is at or above the hint
+    unsigned int high = hint;
+    while(high >= step && Order::less(p,_segments[run[high - step]])) {
+      high -= step;
+      step *= 2;
+    }
+    unsigned int low = high >= step ? high - step + 1 : 0;
+    return bisect<Order>(run,p,low,high);
+  }
+
+  template <class Kernel>
+  void BasicSlabIndex<Kernel>::search(unsigned int count,
+				      const unsigned int* slabs,
+				      const point_t* const* points,
+				      unsigned int* low,
+				      unsigned int* high) const {
+    if(_rectilinear)
+      interleave< BasicRectilinearOrder<Kernel> >(count,slabs,points,low,high);
+    else
+      interleave< BasicSlabOrder<Kernel> >(count,slabs,points,low,high);
+  }
+
+  template <class Kernel>
+  template <class Order>
+  void BasicSlabIndex<Kernel>::interleave(unsigned int count,
+					  const unsigned int* slabs,
+					  const point_t* const* points,
+					  unsigned int* low,
+					  unsigned int* high) const {
+    for(unsigned int i = 0; i < count; ++i) {
+      low[i] = 0;
+      high[i] = size(slabs[i]);
+    }
+    bool searching = true;
+    while(searching) {
+      // the probes, then the segments they name, are on their way before
+      // any of them is needed
+      for(unsigned int i = 0; i < count; ++i)
+	if(low[i] < high[i])
+	  __builtin_prefetch(_runs + _offsets[slabs[i]] +
+			     low[i] + (high[i] - low[i]) / 2);
+      for(unsigned int i = 0; i < count; ++i)
+	if(low[i] < high[i]) {
+	  const segment_t* s = _segments +
+	    _runs[_offsets[slabs[i]] + low[i] + (high[i] - low[i]) / 2];
+	  __builtin_prefetch(s);
+	  __builtin_prefetch(reinterpret_cast<const char*>(s + 1) - 1);
+	}
+      searching = false;
+      for(unsigned int i = 0; i < count; ++i)
+	if(low[i] < high[i]) {
+	  unsigned int middle = low[i] + (high[i] - low[i]) / 2;
+	  if(Order::less(*points[i],
+			 _segments[_runs[_offsets[slabs[i]] + middle]]))
+	    high[i] = middle;
+	  else
+	    low[i] = middle + 1;
+	  searching = searching || low[i] < high[i];
+	}
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_SLABINDEX(K)		\
+  template class BasicSlabIndex<K>;
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_SLABINDEX)
+}
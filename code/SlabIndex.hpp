@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SlabIndex.hpp                                                    //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: A read-only, flattened copy of every version of the sweep        //
+//          structure, searched by binary search.                            //
+//                                                                           //
+// NOTES:   The segments are the subdivision's table, referred to by their   //
+//          handles, and owned by the subdivision.  The slab directory       //
+//          gives, for each slab, the start of its run of segment indices,   //
+//          ordered from top to bottom; the run of slab i ends where that of //
+//          slab i + 1 starts.  Each slab is stored in full, at 4 bytes per  //
+//          segment crossing it.                                             //
+//                                                                           //
+//          The arrays are reached through pointers, not through the         //
+//          vectors which own them, so that they may also live in memory     //
+//          which the index does not own.                                    //
+//                                                                           //
+//          The interleaved search advances all its binary searches one step //
+//          at a time.  Each step prefetches the probes of every search,     //
+//          then the segments they name, and only then compares, so that     //
+//          the cache misses of the searches overlap instead of following    //
+//          one another.                                                     //
+//                                                                           //
+//          When the segments are rectilinear, those in the slabs are all    //
+//          horizontal, and a search compares y coordinates (see             //
+//          SlabOrder.hpp).                                                  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// assign(segments,count,offsets,runs,  takes over the contents of the       //
+//        rectilinear)                  vectors, leaving them empty          //
+// view(segments,count,offsets,runs,    refers to arrays owned elsewhere,    //
+//      slabs,rectilinear)              which must outlive the index         //
+// empty()                              true before anything is assigned     //
+// size(slab)                           the number of segments in a slab     //
+// segments(), segment_count()          the segments, which runs refer to    //
+// offsets(), runs(), slab_count()      the slab directory and the runs      //
+// handle(slab,position)                the handle of a segment of a slab,   //
+//                                      from the top                         //
+// segment(slab,position)               a segment of a slab, from the top    //
+// search(slab,p)                       the number of segments of the slab   //
+//                                      which are not below the point p      //
+// search(slab,p,hint)                  as above, galloping out from a       //
+//                                      position near the answer             //
+// search(count,slabs,points,low,high)  search(slabs[i],*points[i]) in       //
+//                                      low[i] for each i < count, the       //
+//                                      searches interleaved; high is room   //
+//                                      for count more                       //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef SLABINDEX_HPP
+#define SLABINDEX_HPP
+
+#include <vector>
+#include "Point2D.hpp"
+#include "LineSegment.hpp"
+#include "SlabOrder.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicSlabIndex {
+  public:
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    BasicSlabIndex();
+
+    void assign(const segment_t* segments,
+		unsigned int segment_count,
+		vector<unsigned int>& offsets,
+		vector<unsigned int>& runs,
+		bool rectilinear);
+    void view(const segment_t* segments,
+	      unsigned int segment_count,
+	      const unsigned int* offsets,
+	      const unsigned int* runs,
+	      unsigned int slab_count,
+	      bool rectilinear);
+
+    bool empty() const;
+    unsigned int size(unsigned int slab) const;
+
+    const segment_t* segments() const;
+    unsigned int segment_count() const;
+    const unsigned int* offsets() const;
+    const unsigned int* runs() const;
+    unsigned int slab_count() const;
+
+    unsigned int handle(unsigned int slab, unsigned int position) const {
+      return _runs[_offsets[slab] + position];
+    }
+
+    const segment_t& segment(unsigned int slab, unsigned int position) const {
+      return _segments[_runs[_offsets[slab] + position]];
+    }
+
+    unsigned int search(unsigned int slab, const point_t& p) const;
+    unsigned int search(unsigned int slab,
+			const point_t& p,
+			unsigned int hint) const;
+    void search(unsigned int count,
+		const unsigned int* slabs,
+		const point_t* const* points,
+		unsigned int* low,
+		unsigned int* high) const;
+
+  private:
+    // the answer in [low,high) of the run, or high
+    template <class Order>
+    unsigned int bisect(const unsigned int* run,
+			const point_t& p,
+			unsigned int low,
+			unsigned int high) const;
+
+    template <class Order>
+    void interleave(unsigned int count,
+		    const unsigned int* slabs,
+		    const point_t* const* points,
+		    unsigned int* low,
+		    unsigned int* high) const;
+
+    template <class Order>
+    unsigned int gallop(const unsigned int* run,
+			unsigned int n,
+			const point_t& p,
+			unsigned int hint) const;
+
+    // not copyable, the views point into the storage
+    BasicSlabIndex(const BasicSlabIndex&);
+    BasicSlabIndex& operator=(const BasicSlabIndex&);
+
+    vector<unsigned int> _offset_storage;
+    vector<unsigned int> _run_storage;
+
+    const segment_t* _segments;
+    const unsigned int* _offsets;
+    const unsigned int* _runs;
+    unsigned int _segment_count;
+    unsigned int _slab_count;
+    bool _rectilinear;
+  };
+}
+
+#endif
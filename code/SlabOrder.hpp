@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    SlabOrder.hpp                                                    //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: The order of the segments within a slab, from the top, and of a  //
+//          query point among them, decided by one orientation test.         //
+//                                                                           //
+// NOTES:   BasicLineSegment::operator< orders any two segments, for which   //
+//          it evaluates all of ydesc, yasc, xdesc and xasc, up to eight     //
+//          orientation tests.  Within a slab, it is decided by ydesc or     //
+//          yasc alone, each of which is the side of one segment's line on   //
+//          which an end point of the other lies.  The line is that of the   //
+//          left and right end points, which the segment already stores in   //
+//          that order, so the orientation predicate of the kernel is the    //
+//          line equation evaluated exactly, and filtered where the kernel   //
+//          filters.  A slope and intercept would not be exact with integer  //
+//          or rational coordinates.                                         //
+//                                                                           //
+//          Where the end point lies on the other line, or the pair is not   //
+//          one that meets in a slab, operator< decides, so that the order   //
+//          is always the same as its order.                                 //
+//                                                                           //
+//          A query point p is compared as the segment (p,p), but without    //
+//          making that segment: where operator< would decide, the flags it  //
+//          would evaluate for (p,p) are evaluated from p itself, so that a  //
+//          query copies no coordinates.                                     //
+//                                                                           //
+//          The line of a horizontal segment needs no orientation test: the  //
+//          side of a point is that of its y.  In a rectilinear subdivision, //
+//          where every segment of a slab is horizontal, a query point is    //
+//          placed by comparing y coordinates alone (BasicRectilinearOrder), //
+//          and only where it is level with a segment does BasicSlabOrder    //
+//          decide.                                                          //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// less(a,b)                            a < b, where a and b are segments of //
+//                                      a slab, or one of them is the        //
+//                                      segment (p,p) of a query point p     //
+// less(p,b), less(a,p)                 as above, for the query point p      //
+// BasicRectilinearOrder::less(p,b)     less(p,b), where b is horizontal and //
+//                                      p is not left of it                  //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef SLABORDER_HPP
+#define SLABORDER_HPP
+
+#include "Point2D.hpp"
+#include "LineSegment.hpp"
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicSlabOrder {
+  public:
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    static bool less(const segment_t& a, const segment_t& b) {
+      const point_t& al = a.getLeftEndPoint();
+      const point_t& ar = a.getRightEndPoint();
+      const point_t& bl = b.getLeftEndPoint();
+      const point_t& br = b.getRightEndPoint();
+      int side = 0;
+      if(al.x < ar.x && bl.x < br.x) {
+	// both in the slab: the one starting further left is cut by the
+	// line of the other
+	if(al.x < bl.x)
+	  side = -line_side(a,bl);
+	else
+	  side = line_side(b,al);
+      } else if(bl.x < br.x && al == ar && !(al.x < bl.x)) {
+	// a query point at or right of the left end of b
+	side = line_side(b,al);
+      } else if(al.x < ar.x && bl == br && al.x < bl.x) {
+	// a query point right of the left end of a
+	side = -line_side(a,bl);
+      }
+      if(side != 0)
+	return side > 0;
+      return a < b;
+    }
+
+    // (p,p) < b
+    static bool less(const point_t& p, const segment_t& b) {
+      const point_t& bl = b.getLeftEndPoint();
+      const point_t& br = b.getRightEndPoint();
+      int side = 0;
+      if(bl.x < br.x && !(p.x < bl.x))
+	side = line_side(b,p);
+      if(side != 0)
+	return side > 0;
+
+      // as operator< takes the flags, with (p,p) as this
+      bool yasc_flag, ydesc_flag;
+      if(p.x < bl.x) {
+	ydesc_flag = ydesc(p,b);
+	yasc_flag = yasc(p,b);
+      } else {
+	yasc_flag = ydesc(b,p);
+	ydesc_flag = yasc(b,p);
+      }
+      if(ydesc_flag)
+	return true;
+      if(yasc_flag)
+	return false;
+      if(p.y < b.getBottomEndPoint().y)
+	return xdesc(p,b);
+      return xasc(b,p);
+    }
+
+    // a < (p,p)
+    static bool less(const segment_t& a, const point_t& p) {
+      const point_t& al = a.getLeftEndPoint();
+      const point_t& ar = a.getRightEndPoint();
+      int side = 0;
+      if(al.x < ar.x && al.x < p.x)
+	side = -line_side(a,p);
+      if(side != 0)
+	return side > 0;
+
+      // as operator< takes the flags, with (p,p) as other
+      bool yasc_flag, ydesc_flag;
+      if(al.x < p.x) {
+	ydesc_flag = ydesc(a,p);
+	yasc_flag = yasc(a,p);
+      } else {
+	yasc_flag = ydesc(p,a);
+	ydesc_flag = yasc(p,a);
+      }
+      if(ydesc_flag)
+	return true;
+      if(yasc_flag)
+	return false;
+      if(a.getBottomEndPoint().y < p.y)
+	return xdesc(a,p);
+      return xasc(p,a);
+    }
+
+  private:
+    // the orientation of the left and right end points of a non-vertical
+    // segment and c, which for a horizontal one is the side of its y
+    static int line_side(const segment_t& s, const point_t& c) {
+      if(s.isHorizontal()) {
+	const point_t& l = s.getLeftEndPoint();
+	return l.y < c.y ? 1 : c.y < l.y ? -1 : 0;
+      }
+      return point_t::orientation(s.getLeftEndPoint(),
+				  s.getRightEndPoint(),
+				  c);
+    }
+
+    // BasicLineSegment's ydesc, yasc, xdesc and xasc where one of the
+    // segments is (p,p), which is both vertical and horizontal
+    static bool ydesc(const segment_t& s, const point_t& p) {
+      if(s.isVertical()) {
+	if(s.getBottomEndPoint().y > p.y)
+	  return true;
+	if(s.getBottomEndPoint().y < p.y)
+	  return false;
+	return s.getTopEndPoint().y > p.y;
+      }
+      int side = point_t::orientation(s.getLeftEndPoint(),
+				      s.getRightEndPoint(),
+				      p);
+      if(side == 0)
+	return s.getBottomEndPoint().y > p.y;
+      return side < 0;
+    }
+
+    static bool yasc(const segment_t& s, const point_t& p) {
+      if(s.isVertical()) {
+	if(s.getBottomEndPoint().y < p.y)
+	  return true;
+	if(s.getBottomEndPoint().y > p.y)
+	  return false;
+	return s.getTopEndPoint().y < p.y;
+      }
+      int side = point_t::orientation(s.getLeftEndPoint(),
+				      s.getRightEndPoint(),
+				      p);
+      if(side == 0)
+	return s.getBottomEndPoint().y < p.y;
+      return side > 0;
+    }
+
+    static bool ydesc(const point_t& p, const segment_t& s) {
+      if(s.isVertical()) {
+	if(p.y > s.getBottomEndPoint().y)
+	  return true;
+	if(p.y < s.getBottomEndPoint().y)
+	  return false;
+	return p.y > s.getTopEndPoint().y;
+      }
+      return p.y > s.getLeftEndPoint().y;
+    }
+
+    static bool yasc(const point_t& p, const segment_t& s) {
+      if(s.isVertical()) {
+	if(p.y < s.getBottomEndPoint().y)
+	  return true;
+	if(p.y > s.getBottomEndPoint().y)
+	  return false;
+	return p.y < s.getTopEndPoint().y;
+      }
+      return p.y < s.getLeftEndPoint().y;
+    }
+
+    static bool xdesc(const segment_t& s, const point_t& p) {
+      if(s.isHorizontal())
+	return s.getLeftEndPoint().x > p.x;
+      return point_t::rightTurn(s.getBottomEndPoint(),s.getTopEndPoint(),p);
+    }
+
+    static bool xasc(const segment_t& s, const point_t& p) {
+      if(s.isHorizontal())
+	return s.getLeftEndPoint().x < p.x;
+      return point_t::leftTurn(s.getBottomEndPoint(),s.getTopEndPoint(),p);
+    }
+
+    static bool xdesc(const point_t& p, const segment_t& s) {
+      if(s.isHorizontal())
+	return p.x > s.getLeftEndPoint().x;
+      return p.x > s.getBottomEndPoint().x;
+    }
+
+    static bool xasc(const point_t& p, const segment_t& s) {
+      if(s.isHorizontal())
+	return p.x < s.getLeftEndPoint().x;
+      return p.x < s.getBottomEndPoint().x;
+    }
+  };
+
+  template <class Kernel>
+  class BasicRectilinearOrder {
+  public:
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    static bool less(const point_t& p, const segment_t& b) {
+      const typename point_t::coord_t& y = b.getLeftEndPoint().y;
+      if(y < p.y)
+	return true;
+      if(p.y < y)
+	return false;
+      return BasicSlabOrder<Kernel>::less(p,b);
+    }
+  };
+}
+
+#endif
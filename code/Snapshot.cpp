@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Snapshot.cpp                                                     //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// NOTES:   The checksum is FNV-1a taken a 64 bit word at a time rather than //
+//          a byte at a time, so that checking a large file costs little     //
+//          more than reading it.                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <string>
+#include "Snapshot.hpp"
+
+namespace geometry {
+  const char SNAPSHOT_MAGIC[8] = { 'P','S','L','S','N','A','P','\0' };
+  const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304u;
+
+  // folds bytes, zero padded to a multiple of 8, into the checksum
+  static uint64_t checksum(uint64_t state, const char* data, uint64_t bytes) {
+    const uint64_t prime = (uint64_t(0x00000100u) << 32) | 0x000001b3u;
+    uint64_t word;
+    for(; bytes >= 8; bytes -= 8, data += 8) {
+      memcpy(&word,data,8);
+      state = (state ^ word) * prime;
+    }
+    if(bytes > 0) {
+      word = 0;
+      memcpy(&word,data,bytes);
+      state = (state ^ word) * prime;
+    }
+    return state;
+  }
+
+  static uint64_t checksumStart() {
+    return (uint64_t(0xcbf29ce4u) << 32) | 0x84222325u;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // SnapshotWriter implementation                                           //
+  /////////////////////////////////////////////////////////////////////////////
+  SnapshotWriter::SnapshotWriter(const char* path)
+    : _out(path,ios::out | ios::binary | ios::trunc),
+      _checksum(checksumStart()),
+      _bytes(0)
+  {
+    if(!_out)
+      throw string("Could not create ") + path;
+    SnapshotHeader blank;
+    memset(&blank,0,sizeof(blank));
+    _out.write(reinterpret_cast<const char*>(&blank),sizeof(blank));
+  }
+
+  void SnapshotWriter::section(const void* data, uint64_t bytes) {
+    const char zeros[8] = { 0 };
+    uint64_t padding = (8 - bytes % 8) % 8;
+    if(bytes > 0)
+      _out.write(static_cast<const char*>(data),bytes);
+    _out.write(zeros,padding);
+    if(!_out)
+      throw string("Could not write the snapshot");
+    _checksum = checksum(_checksum,static_cast<const char*>(data),bytes);
+    _bytes += bytes + padding;
+  }
+
+  void SnapshotWriter::finish(SnapshotHeader& header) {
+    memcpy(header.magic,SNAPSHOT_MAGIC,sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.payload_bytes = _bytes;
+    header.checksum = _checksum;
+    _out.seekp(0);
+    _out.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    _out.flush();
+    if(!_out)
+      throw string("Could not write the snapshot");
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // SnapshotReader implementation                                           //
+  /////////////////////////////////////////////////////////////////////////////
+  SnapshotReader::SnapshotReader()
+    : _file(),
+      _position(0)
+  {
+    memset(&_header,0,sizeof(_header));
+  }
+
+  void SnapshotReader::open(const char* path, bool verify) {
+    _file.open(path);
+    if(_file.size() < sizeof(_header))
+      throw string("Not a snapshot: ") + path;
+    memcpy(&_header,_file.data(),sizeof(_header));
+    if(memcmp(_header.magic,SNAPSHOT_MAGIC,sizeof(_header.magic)) != 0)
+      throw string("Not a snapshot: ") + path;
+    if(_header.version != SNAPSHOT_VERSION)
+      throw string("Unsupported snapshot version: ") + path;
+    if(_header.byte_order != SNAPSHOT_BYTE_ORDER)
+      throw string("Snapshot written with another byte order: ") + path;
+    if(_header.payload_bytes != _file.size() - sizeof(_header))
+      throw string("Truncated snapshot: ") + path;
+    if(verify &&
+       checksum(checksumStart(),_file.data() + sizeof(_header),
+		_header.payload_bytes) != _header.checksum)
+      throw string("Corrupt snapshot: ") + path;
+    _position = sizeof(_header);
+  }
+
+  const SnapshotHeader& SnapshotReader::header() const {
+    return _header;
+  }
+
+  const char* SnapshotReader::section(uint64_t bytes) {
+    uint64_t padded = bytes + (8 - bytes % 8) % 8;
+    if(padded > _file.size() - _position)
+      throw string("Truncated snapshot");
+    const char* data = _file.data() + _position;
+    _position += padded;
+    return data;
+  }
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Snapshot.hpp                                                     //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: The binary file a frozen subdivision is saved to: a header       //
+//          followed by sections of raw data, read back in place from a      //
+//          memory mapping.                                                  //
+//                                                                           //
+// NOTES:   Each section starts 8 byte aligned, padded with zeros, so that   //
+//          arrays of coordinates and indices may be used where they lie in  //
+//          the mapping.  The data is stored in the byte order and layout    //
+//          of the machine which wrote it; the header records both, and a    //
+//          checksum of everything after it.                                 //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// SnapshotWriter(path)                 creates the file, leaving room for   //
+//                                      the header                           //
+// section(data,bytes)                  appends a section                    //
+// finish(header)                       completes and writes the header      //
+// open(path,verify)                    maps a file and checks its header,   //
+//                                      and its checksum if verify is set    //
+// header()                             the header of the mapped file        //
+// section(bytes)                       the next section of the file         //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <stdint.h>
+#include <fstream>
+#include "MappedFile.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  // changes whenever the layout of the file does
+  const uint32_t SNAPSHOT_VERSION = 4;
+
+  // set in the flags of the header when every segment is horizontal or
+  // vertical
+  const uint32_t SNAPSHOT_RECTILINEAR = 1;
+
+  struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    // 0x01020304 as written, to detect a change of byte order
+    uint32_t byte_order;
+    // identifies the kernel and the size of its segments, set by the
+    // writer's owner, which checks them on reading
+    uint32_t kernel;
+    uint32_t segment_bytes;
+    // SNAPSHOT_RECTILINEAR or not
+    uint32_t flags;
+    uint32_t reserved;
+    // the number of each kind of element; the verticals are the last of
+    // the segments
+    uint64_t sweep_points;
+    uint64_t verticals;
+    uint64_t segments;
+    uint64_t slabs;
+    uint64_t runs;
+    uint64_t faces;
+    // the bytes after the header, and their checksum
+    uint64_t payload_bytes;
+    uint64_t checksum;
+  };
+
+  class SnapshotWriter {
+  public:
+    SnapshotWriter(const char* path);
+
+    void section(const void* data, uint64_t bytes);
+    void finish(SnapshotHeader& header);
+
+  private:
+    ofstream _out;
+    uint64_t _checksum;
+    uint64_t _bytes;
+  };
+
+  class SnapshotReader {
+  public:
+    SnapshotReader();
+
+    void open(const char* path, bool verify);
+    const SnapshotHeader& header() const;
+    const char* section(uint64_t bytes);
+
+  private:
+    io::MappedFile _file;
+    SnapshotHeader _header;
+    uint64_t _position;
+  };
+}
+
+#endif
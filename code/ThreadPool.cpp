@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    ThreadPool.cpp                                                   //
+//                                                                           //
+// MODULE:  Concurrency                                                      //
+//                                                                           //
+// NOTES:   None.                                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <exception>
+#include <new>
+#include "ThreadPool.hpp"
+
+namespace concurrency {
+  /////////////////////////////////////////////////////////////////////////////
+  // ThreadPool implementation                                               //
+  /////////////////////////////////////////////////////////////////////////////
+  ThreadPool::Task::~Task() {
+  }
+
+  ThreadPool::ThreadPool(unsigned int threads)
+    : _threads(),
+      _workers(threads > 0 ? threads : 1),
+      _task(0),
+      _generation(0),
+      _running(0),
+      _stopping(false),
+      _failure(NO_FAILURE),
+      _failure_message(0),
+      _failure_string()
+  {
+    pthread_mutex_init(&_mutex,0);
+    pthread_cond_init(&_started,0);
+    pthread_cond_init(&_finished,0);
+    for(unsigned int i = 0; i < _workers.size(); ++i) {
+      _workers[i].pool = this;
+      _workers[i].id = i;
+    }
+    // worker 0 is the thread calling run()
+    for(unsigned int i = 1; i < _workers.size(); ++i) {
+      pthread_t thread;
+      if(pthread_create(&thread,0,&ThreadPool::work,&_workers[i]) != 0)
+	throw "Could not start worker thread";
+      _threads.push_back(thread);
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    pthread_mutex_lock(&_mutex);
+    _stopping = true;
+    pthread_cond_broadcast(&_started);
+    pthread_mutex_unlock(&_mutex);
+    for(unsigned int i = 0; i < _threads.size(); ++i)
+      pthread_join(_threads[i],0);
+    pthread_cond_destroy(&_finished);
+    pthread_cond_destroy(&_started);
+    pthread_mutex_destroy(&_mutex);
+  }
+
+  unsigned int ThreadPool::size() const {
+    return _workers.size();
+  }
+
+  void ThreadPool::run(Task& task) {
+    pthread_mutex_lock(&_mutex);
+    _task = &task;
+    _running = _threads.size();
+    _failure = NO_FAILURE;
+    ++_generation;
+    pthread_cond_broadcast(&_started);
+    pthread_mutex_unlock(&_mutex);
+
+    run_worker(task,0);
+
+    // the other workers still use the task, even when one has failed
+    pthread_mutex_lock(&_mutex);
+    while(_running > 0)
+      pthread_cond_wait(&_finished,&_mutex);
+    _task = 0;
+    Failure failure = _failure;
+    const char* message = _failure_message;
+    string str;
+    str.swap(_failure_string);
+    pthread_mutex_unlock(&_mutex);
+
+    switch(failure) {
+    case NO_FAILURE:
+      return;
+    case MESSAGE_FAILURE:
+      throw message;
+    case STRING_FAILURE:
+      throw str;
+    case BAD_ALLOC_FAILURE:
+      throw std::bad_alloc();
+    case UNKNOWN_FAILURE:
+      throw "A worker thread threw an exception of an unknown type";
+    }
+  }
+
+  // runs a worker's part of the task, keeping what it throws for run()
+  void ThreadPool::run_worker(Task& task, unsigned int worker) {
+    try {
+      task.run(worker);
+    } catch(const char* message) {
+      fail(MESSAGE_FAILURE,message,0);
+    } catch(const string& str) {
+      fail(STRING_FAILURE,0,&str);
+    } catch(const std::bad_alloc&) {
+      fail(BAD_ALLOC_FAILURE,0,0);
+    } catch(const std::exception& e) {
+      fail(STRING_FAILURE,e.what(),0);
+    } catch(...) {
+      fail(UNKNOWN_FAILURE,0,0);
+    }
+  }
+
+  // keeps the first failure of a run; a string failure is the string
+  // str, or else the text of message
+  void ThreadPool::fail(Failure failure,
+			const char* message,
+			const string* str) {
+    pthread_mutex_lock(&_mutex);
+    if(_failure == NO_FAILURE) {
+      _failure = failure;
+      _failure_message = message;
+      // copying the string may itself run out of memory
+      try {
+	if(failure == STRING_FAILURE)
+	  _failure_string = str != 0 ? *str : string(message);
+      } catch(const std::bad_alloc&) {
+	_failure = BAD_ALLOC_FAILURE;
+      }
+    }
+    pthread_mutex_unlock(&_mutex);
+  }
+
+  void* ThreadPool::work(void* argument) {
+    Worker* worker = static_cast<Worker*>(argument);
+    ThreadPool* pool = worker->pool;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->_mutex);
+    while(true) {
+      while(pool->_generation == seen && !pool->_stopping)
+	pthread_cond_wait(&pool->_started,&pool->_mutex);
+      if(pool->_stopping)
+	break;
+      seen = pool->_generation;
+      Task* task = pool->_task;
+      pthread_mutex_unlock(&pool->_mutex);
+
+      pool->run_worker(*task,worker->id);
+
+      pthread_mutex_lock(&pool->_mutex);
+      if(--pool->_running == 0)
+	pthread_cond_signal(&pool->_finished);
+    }
+    pthread_mutex_unlock(&pool->_mutex);
+    return 0;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // WorkQueue implementation                                                //
+  /////////////////////////////////////////////////////////////////////////////
+  WorkQueue::WorkQueue(unsigned int items,
+		       unsigned int workers,
+		       unsigned int grain)
+    : _items(items),
+      _grain(grain > 0 ? grain : 1),
+      _shares(workers > 0 ? workers : 1)
+  {
+    uint64_t chunks = (uint64_t(items) + _grain - 1) / _grain;
+    for(unsigned int i = 0; i < _shares.size(); ++i) {
+      uint64_t front = chunks * i / _shares.size();
+      uint64_t back = chunks * (i + 1) / _shares.size();
+      _shares[i].range = (front << 32) | back;
+    }
+  }
+
+  // the ranges are read with an atomic no-op, as a plain read could race
+  // with another worker's compare and swap
+  bool WorkQueue::take_front(unsigned int worker, unsigned int& chunk) {
+    volatile uint64_t& range = _shares[worker].range;
+    while(true) {
+      uint64_t old = __sync_fetch_and_or(&range,0);
+      uint64_t front = old >> 32;
+      uint64_t back = old & 0xffffffffu;
+      if(front >= back)
+	return false;
+      if(__sync_bool_compare_and_swap(&range,old,((front + 1) << 32) | back)) {
+	chunk = front;
+	return true;
+      }
+    }
+  }
+
+  bool WorkQueue::take_back(unsigned int worker, unsigned int& chunk) {
+    volatile uint64_t& range = _shares[worker].range;
+    while(true) {
+      uint64_t old = __sync_fetch_and_or(&range,0);
+      uint64_t front = old >> 32;
+      uint64_t back = old & 0xffffffffu;
+      if(front >= back)
+	return false;
+      if(__sync_bool_compare_and_swap(&range,old,(front << 32) | (back - 1))) {
+	chunk = back - 1;
+	return true;
+      }
+    }
+  }
+
+  bool WorkQueue::next(unsigned int worker,
+		       unsigned int& begin,
+		       unsigned int& end) {
+    unsigned int chunk;
+    bool found = take_front(worker,chunk);
+    // steal, starting with the next worker so thieves spread out
+    for(unsigned int i = 1; !found && i < _shares.size(); ++i)
+      found = take_back((worker + i) % _shares.size(),chunk);
+    if(!found)
+      return false;
+    begin = chunk * _grain;
+    end = begin + _grain < _items ? begin + _grain : _items;
+    return true;
+  }
+}
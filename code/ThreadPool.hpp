@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    ThreadPool.hpp                                                   //
+//                                                                           //
+// MODULE:  Concurrency                                                      //
+//                                                                           //
+// PURPOSE: A fixed set of pthreads which run a task together, and a work    //
+//          queue from which they take and steal ranges of work items.       //
+//                                                                           //
+// NOTES:   The thread calling run() takes part as worker 0, so a pool of    //
+//          one thread runs the task without any synchronization.            //
+//                                                                           //
+//          An exception cannot leave a worker thread, so run() catches      //
+//          those of every worker, waits for all of them to return, and      //
+//          then throws the first on the calling thread: a const char* or    //
+//          string as it was thrown, bad_alloc as bad_alloc, another         //
+//          std::exception as the string of its what(), and anything else    //
+//          as a const char*.                                                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// ThreadPool(threads)                  starts threads - 1 worker threads    //
+// size()                               the number of workers                //
+// run(task)                            calls task.run(w) for each worker w, //
+//                                      waits until all have returned, and   //
+//                                      throws what the first one threw      //
+// WorkQueue(items,workers,grain)       splits items into chunks of grain    //
+// next(worker,begin,end)               the next chunk for a worker, stolen  //
+//                                      from another when its own are done   //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace concurrency {
+
+  class ThreadPool {
+  public:
+    class Task {
+    public:
+      virtual ~Task();
+      virtual void run(unsigned int worker) = 0;
+    };
+
+    ThreadPool(unsigned int threads);
+    ~ThreadPool();
+
+    unsigned int size() const;
+    void run(Task& task);
+
+  private:
+    struct Worker {
+      ThreadPool* pool;
+      unsigned int id;
+    };
+
+    // the kinds of exception run() carries to the calling thread
+    enum Failure {
+      NO_FAILURE,
+      MESSAGE_FAILURE,
+      STRING_FAILURE,
+      BAD_ALLOC_FAILURE,
+      UNKNOWN_FAILURE
+    };
+
+    static void* work(void* worker);
+    void run_worker(Task& task, unsigned int worker);
+    void fail(Failure failure, const char* message, const string* str);
+
+    vector<pthread_t> _threads;
+    vector<Worker> _workers;
+    pthread_mutex_t _mutex;
+    pthread_cond_t _started;
+    pthread_cond_t _finished;
+    Task* _task;
+    unsigned long _generation;
+    unsigned int _running;
+    bool _stopping;
+    // the first exception of the present run, guarded by _mutex
+    Failure _failure;
+    const char* _failure_message;
+    string _failure_string;
+
+    // not copyable
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // WorkQueue                                                               //
+  //                                                                         //
+  // Each worker starts with an equal share of the chunks and takes them     //
+  // from the front.  A worker whose share is used up steals single chunks   //
+  // from the back of the others, so uneven chunks still balance out.  The   //
+  // front and back of a share are packed into one word and updated with     //
+  // compare and swap, so no locks are taken.                                //
+  /////////////////////////////////////////////////////////////////////////////
+  class WorkQueue {
+  public:
+    WorkQueue(unsigned int items, unsigned int workers, unsigned int grain);
+
+    bool next(unsigned int worker, unsigned int& begin, unsigned int& end);
+
+  private:
+    bool take_front(unsigned int worker, unsigned int& chunk);
+    bool take_back(unsigned int worker, unsigned int& chunk);
+
+    unsigned int _items;
+    unsigned int _grain;
+    // [front,back) of the chunks left in each share, front in the high
+    // half of the word; each entry is padded to its own cache line
+    struct Share {
+      volatile uint64_t range;
+      char padding[64 - sizeof(uint64_t)];
+    };
+    vector<Share> _shares;
+  };
+}
+
+#endif
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Trace.cpp                                                        //
+//                                                                           //
+// MODULE:  Diagnostics                                                      //
+//                                                                           //
+// NOTES:   Writers claim a slot with an atomic increment and publish it by  //
+//          storing its sequence number last, so readers can skip slots      //
+//          that are being overwritten.                                      //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "Trace.hpp"
+
+namespace trace {
+  namespace {
+    struct Slot {
+      // zero while the slot is being written, otherwise its index + 1
+      volatile unsigned long sequence;
+      int category;
+      int level;
+      char text[MESSAGE_SIZE + 1];
+    };
+
+    Slot buffer[BUFFER_SIZE];
+    volatile unsigned long next = 0;
+
+    const char* categoryName(int category) {
+      switch(category) {
+      case TRACE_COMPARATOR: return "comparator";
+      case TRACE_SWEEP:      return "sweep";
+      case TRACE_QUERY:      return "query";
+      }
+      return "other";
+    }
+
+    const char* levelName(int level) {
+      switch(level) {
+      case TRACE_ERROR:   return "error";
+      case TRACE_INFO:    return "info";
+      case TRACE_DEBUG:   return "debug";
+      case TRACE_VERBOSE: return "verbose";
+      }
+      return "other";
+    }
+  }
+
+  void record(int category, int level, const std::string& text) {
+    unsigned long index = __sync_fetch_and_add(&next,1);
+    Slot& slot = buffer[index % BUFFER_SIZE];
+    slot.sequence = 0;
+    __sync_synchronize();
+    slot.category = category;
+    slot.level = level;
+    size_t length = text.copy(slot.text,MESSAGE_SIZE);
+    slot.text[length] = '\0';
+    __sync_synchronize();
+    slot.sequence = index + 1;
+  }
+
+  void dump(std::ostream& os) {
+    unsigned long end = next;
+    unsigned long begin = end > BUFFER_SIZE ? end - BUFFER_SIZE : 0;
+    for(unsigned long index = begin; index < end; ++index) {
+      Slot& slot = buffer[index % BUFFER_SIZE];
+      if(slot.sequence != index + 1)
+	continue;
+      int category = slot.category;
+      int level = slot.level;
+      char text[MESSAGE_SIZE + 1];
+      memcpy(text,slot.text,sizeof(text));
+      text[MESSAGE_SIZE] = '\0';
+      __sync_synchronize();
+      // skip the message if a writer reused the slot while it was copied
+      if(slot.sequence != index + 1)
+	continue;
+      os << "[" << categoryName(category) << ":" << levelName(level) << "] "
+	 << text << std::endl;
+    }
+  }
+
+  // not safe against concurrent writers
+  void clear() {
+    for(unsigned int i = 0; i < BUFFER_SIZE; ++i)
+      buffer[i].sequence = 0;
+    next = 0;
+  }
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Trace.hpp                                                        //
+//                                                                           //
+// MODULE:  Diagnostics                                                      //
+//                                                                           //
+// PURPOSE: Compile-time filtered tracing into an in-memory ring buffer.     //
+//                                                                           //
+// NOTES:   TRACE_LEVEL selects the most detailed level kept (0, the         //
+//          default, removes every trace statement) and TRACE_CATEGORIES     //
+//          is a mask of the categories kept.  Both are compile-time         //
+//          constants, so a disabled statement does not evaluate or format   //
+//          its message.  Enabled statements are written to a fixed ring     //
+//          buffer without locking; dump() prints its contents.              //
+//                                                                           //
+//          Example:                                                         //
+//            TRACE(TRACE_SWEEP, TRACE_DEBUG, "Considering x=" << x);        //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// trace::record(category,level,text)   appends a message to the buffer      //
+// trace::dump(os)                      prints the buffered messages         //
+// trace::clear()                       discards the buffered messages       //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// levels
+#define TRACE_ERROR     1
+#define TRACE_INFO      2
+#define TRACE_DEBUG     3
+#define TRACE_VERBOSE   4
+
+// categories
+#define TRACE_COMPARATOR 1
+#define TRACE_SWEEP      2
+#define TRACE_QUERY      4
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 0
+#endif
+
+#ifndef TRACE_CATEGORIES
+#define TRACE_CATEGORIES (TRACE_COMPARATOR | TRACE_SWEEP | TRACE_QUERY)
+#endif
+
+// true when statements of this category and level are compiled in
+#define TRACE_ENABLED(category,level)					\
+  (((category) & (TRACE_CATEGORIES)) != 0 && (level) <= (TRACE_LEVEL))
+
+#if TRACE_LEVEL > 0
+#define TRACE(category,level,message)					\
+  do {									\
+    if(TRACE_ENABLED(category,level)) {					\
+      std::ostringstream trace_stream;					\
+      trace_stream << message;						\
+      trace::record((category),(level),trace_stream.str());		\
+    }									\
+  } while(0)
+#else
+#define TRACE(category,level,message) do {} while(0)
+#endif
+
+namespace trace {
+  // number of messages kept; older ones are overwritten
+  const unsigned int BUFFER_SIZE = 4096;
+
+  // longer messages are truncated
+  const unsigned int MESSAGE_SIZE = 247;
+
+  void record(int category, int level, const std::string& text);
+  void dump(std::ostream& os);
+  void clear();
+}
+
+#endif
@@ -0,0 +1,376 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    TrapezoidalMap.cpp                                               //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// NOTES:   Follows the incremental algorithm of de Berg et al.,             //
+//          Computational Geometry, chapter 6.  Trapezoids which a segment   //
+//          replaces are kept until the arena is released, since their       //
+//          leaves become inner nodes of the DAG.                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include "TrapezoidalMap.hpp"
+#include "SlabOrder.hpp"
+#include "Trace.hpp"
+
+namespace geometry {
+  /////////////////////////////////////////////////////////////////////////////
+  // BasicTrapezoidalMap implementation                                      //
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  BasicTrapezoidalMap<Kernel>::BasicTrapezoidalMap(memory::Arena& arena)
+    : _arena(arena),
+      _segments(0),
+      _segment_count(0),
+      _trapezoids(),
+      _node_count(0),
+      _root(0),
+      _live(0)
+  {
+  }
+
+  template <class Kernel>
+  BasicTrapezoidalMap<Kernel>::~BasicTrapezoidalMap() {
+    clear();
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::clear() {
+    // the trapezoids and nodes stay in the arena until it is released
+    vector<Trapezoid*>().swap(_trapezoids);
+    _node_count = 0;
+    _segments = 0;
+    _segment_count = 0;
+    _root = 0;
+    _live = 0;
+  }
+
+  template <class Kernel>
+  bool BasicTrapezoidalMap<Kernel>::lexLess(const point_t& a,
+					    const point_t& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::replaceLeft(Trapezoid* t,
+						Trapezoid* from,
+						Trapezoid* to) {
+    if(!t)
+      return;
+    if(t->upper_left == from)
+      t->upper_left = to;
+    if(t->lower_left == from)
+      t->lower_left = to;
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::replaceRight(Trapezoid* t,
+						 Trapezoid* from,
+						 Trapezoid* to) {
+    if(!t)
+      return;
+    if(t->upper_right == from)
+      t->upper_right = to;
+    if(t->lower_right == from)
+      t->lower_right = to;
+  }
+
+  template <class Kernel>
+  typename BasicTrapezoidalMap<Kernel>::Trapezoid*
+  BasicTrapezoidalMap<Kernel>::newTrapezoid(unsigned int top,
+					    unsigned int bottom,
+					    const point_t* leftp,
+					    const point_t* rightp) {
+    Trapezoid* t = _arena.create<Trapezoid>();
+    t->top = top;
+    t->bottom = bottom;
+    t->leftp = leftp;
+    t->rightp = rightp;
+    t->upper_left = t->lower_left = t->upper_right = t->lower_right = 0;
+    t->node = 0;
+    t->live = true;
+    _trapezoids.push_back(t);
+    ++_live;
+    return t;
+  }
+
+  template <class Kernel>
+  typename BasicTrapezoidalMap<Kernel>::Node*
+  BasicTrapezoidalMap<Kernel>::newNode() {
+    ++_node_count;
+    return _arena.create<Node>();
+  }
+
+  template <class Kernel>
+  typename BasicTrapezoidalMap<Kernel>::Node*
+  BasicTrapezoidalMap<Kernel>::leaf(Trapezoid* t) {
+    if(!t->node) {
+      t->node = newNode();
+      t->node->kind = Node::LEAF;
+      t->node->trapezoid = t;
+      t->node->left = t->node->right = 0;
+    }
+    return t->node;
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::setX(Node* n,
+					 const point_t* point,
+					 Node* left,
+					 Node* right) {
+    n->kind = Node::X_NODE;
+    n->point = point;
+    n->trapezoid = 0;
+    n->left = left;
+    n->right = right;
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::setY(Node* n,
+					 unsigned int segment,
+					 Node* above,
+					 Node* below) {
+    n->kind = Node::Y_NODE;
+    n->segment = segment;
+    n->trapezoid = 0;
+    n->left = above;
+    n->right = below;
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::build(const segment_t* segments,
+					  unsigned int count,
+					  unsigned long seed) {
+    clear();
+    _segments = segments;
+    _segment_count = count;
+
+    // the whole plane
+    _root = leaf(newTrapezoid(NONE,NONE,0,0));
+
+    // a random order, from a generator of our own so that the result
+    // depends only on the seed
+    vector<unsigned int> order(_segment_count);
+    for(unsigned int i = 0; i < order.size(); ++i)
+      order[i] = i;
+    const uint64_t multiplier = (uint64_t(0x5851f42du) << 32) | 0x4c957f2du;
+    const uint64_t increment = (uint64_t(0x14057b7eu) << 32) | 0xf767814fu;
+    uint64_t state = seed;
+    for(unsigned int i = order.size(); i > 1; --i) {
+      state = state * multiplier + increment;
+      unsigned int j = (unsigned int)((state >> 33) % i);
+      unsigned int swap = order[i - 1];
+      order[i - 1] = order[j];
+      order[j] = swap;
+    }
+
+    for(unsigned int i = 0; i < order.size(); ++i)
+      insert(order[i]);
+
+    TRACE(TRACE_SWEEP,TRACE_INFO,
+	  "Trapezoidal map of " << _segment_count << " segments: "
+	  << _live << " trapezoids, " << _node_count << " nodes");
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::insert(unsigned int s) {
+    const segment_t& segment = _segments[s];
+    const point_t& p = segment.getLeftEndPoint();
+    const point_t& q = segment.getRightEndPoint();
+    assert(!segment.isVertical());
+
+    // find the trapezoid just right of p, above or below the segments
+    // starting there by the direction of this one
+    Node* n = _root;
+    while(n->kind != Node::LEAF) {
+      if(n->kind == Node::X_NODE) {
+	n = lexLess(p,*n->point) ? n->left : n->right;
+      } else {
+	const segment_t& other = _segments[n->segment];
+	int side = point_t::orientation(other.getLeftEndPoint(),
+					other.getRightEndPoint(),
+					p);
+	if(side == 0)
+	  side = point_t::orientation(other.getLeftEndPoint(),
+				      other.getRightEndPoint(),
+				      q);
+	n = side > 0 ? n->left : n->right;
+      }
+    }
+
+    // follow the segment through the trapezoids it crosses
+    vector<Trapezoid*> crossed(1,n->trapezoid);
+    while(crossed.back()->rightp && lexLess(*crossed.back()->rightp,q)) {
+      Trapezoid* t = crossed.back();
+      if(point_t::orientation(p,q,*t->rightp) > 0)
+	crossed.push_back(t->lower_right);
+      else
+	crossed.push_back(t->upper_right);
+      assert(crossed.back());
+    }
+    unsigned int k = crossed.size();
+    Trapezoid* first = crossed[0];
+    Trapezoid* last = crossed[k - 1];
+
+    // the parts left of p and right of q, unless an end point is shared
+    Trapezoid* left = 0;
+    if(!first->leftp || lexLess(*first->leftp,p))
+      left = newTrapezoid(first->top,first->bottom,first->leftp,&p);
+    Trapezoid* right = 0;
+    if(!last->rightp || lexLess(q,*last->rightp))
+      right = newTrapezoid(last->top,last->bottom,&q,last->rightp);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Above and below the segment, each crossed trapezoid becomes a new
+    // piece.  Where the boundary between two crossed trapezoids is a
+    // vertex below the segment, the pieces above it merge, and where it
+    // is above, those below it merge.
+    ///////////////////////////////////////////////////////////////////////////
+    vector<Trapezoid*> upper(k), lower(k);
+    upper[0] = newTrapezoid(first->top,s,&p,0);
+    lower[0] = newTrapezoid(s,first->bottom,&p,0);
+    for(unsigned int i = 0; i + 1 < k; ++i) {
+      const point_t* v = crossed[i]->rightp;
+      if(point_t::orientation(p,q,*v) > 0) {
+	upper[i]->rightp = v;
+	upper[i + 1] = newTrapezoid(crossed[i + 1]->top,s,v,0);
+	lower[i + 1] = lower[i];
+
+	upper[i]->upper_right = crossed[i]->upper_right;
+	upper[i]->lower_right = upper[i + 1];
+	replaceLeft(crossed[i]->upper_right,crossed[i],upper[i]);
+	upper[i + 1]->upper_left = crossed[i + 1]->upper_left;
+	upper[i + 1]->lower_left = upper[i];
+	replaceRight(crossed[i + 1]->upper_left,crossed[i + 1],upper[i + 1]);
+      } else {
+	lower[i]->rightp = v;
+	lower[i + 1] = newTrapezoid(s,crossed[i + 1]->bottom,v,0);
+	upper[i + 1] = upper[i];
+
+	lower[i]->lower_right = crossed[i]->lower_right;
+	lower[i]->upper_right = lower[i + 1];
+	replaceLeft(crossed[i]->lower_right,crossed[i],lower[i]);
+	lower[i + 1]->lower_left = crossed[i + 1]->lower_left;
+	lower[i + 1]->upper_left = lower[i];
+	replaceRight(crossed[i + 1]->lower_left,crossed[i + 1],lower[i + 1]);
+      }
+    }
+    upper[k - 1]->rightp = &q;
+    lower[k - 1]->rightp = &q;
+
+    // the left side
+    if(left) {
+      left->upper_left = first->upper_left;
+      left->lower_left = first->lower_left;
+      replaceRight(first->upper_left,first,left);
+      replaceRight(first->lower_left,first,left);
+      left->upper_right = upper[0];
+      left->lower_right = lower[0];
+      upper[0]->upper_left = left;
+      lower[0]->lower_left = left;
+    } else {
+      upper[0]->upper_left = first->upper_left;
+      lower[0]->lower_left = first->lower_left;
+      replaceRight(first->upper_left,first,upper[0]);
+      replaceRight(first->lower_left,first,lower[0]);
+    }
+
+    // the right side
+    if(right) {
+      right->upper_right = last->upper_right;
+      right->lower_right = last->lower_right;
+      replaceLeft(last->upper_right,last,right);
+      replaceLeft(last->lower_right,last,right);
+      right->upper_left = upper[k - 1];
+      right->lower_left = lower[k - 1];
+      upper[k - 1]->upper_right = right;
+      lower[k - 1]->lower_right = right;
+    } else {
+      upper[k - 1]->upper_right = last->upper_right;
+      lower[k - 1]->lower_right = last->lower_right;
+      replaceLeft(last->upper_right,last,upper[k - 1]);
+      replaceLeft(last->lower_right,last,lower[k - 1]);
+    }
+
+    // the leaves of the crossed trapezoids become the search for the
+    // new pieces
+    for(unsigned int i = 0; i < k; ++i) {
+      Node* node = crossed[i]->node;
+      bool split_left = i == 0 && left;
+      bool split_right = i == k - 1 && right;
+      Node* y = split_left || split_right ? newNode() : node;
+      setY(y,s,leaf(upper[i]),leaf(lower[i]));
+      if(split_right) {
+	Node* x = split_left ? newNode() : node;
+	setX(x,&q,y,leaf(right));
+	y = x;
+      }
+      if(split_left)
+	setX(node,&p,leaf(left),y);
+      crossed[i]->node = 0;
+      crossed[i]->live = false;
+      --_live;
+    }
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::locate(const point_t& p,
+					   unsigned int& above,
+					   unsigned int& below) const {
+    Node* n = _root;
+    while(n->kind != Node::LEAF) {
+      if(n->kind == Node::X_NODE)
+	// p is moved right, past any vertex with its x coordinate
+	n = p.x < n->point->x ? n->left : n->right;
+      else
+	// and placed against segments as the slabs would place it
+	n = BasicSlabOrder<Kernel>::less(p,_segments[n->segment]) ?
+	  n->left : n->right;
+    }
+    const Trapezoid* t = n->trapezoid;
+    above = t->top;
+    below = t->bottom;
+  }
+
+  template <class Kernel>
+  void BasicTrapezoidalMap<Kernel>::cells(vector<Cell>& out) const {
+    out.clear();
+    out.reserve(_live);
+    for(unsigned int i = 0; i < _trapezoids.size(); ++i) {
+      const Trapezoid* t = _trapezoids[i];
+      if(!t->live)
+	continue;
+      Cell cell;
+      cell.top = t->top;
+      cell.bottom = t->bottom;
+      cell.leftp = t->leftp;
+      cell.rightp = t->rightp;
+      out.push_back(cell);
+    }
+  }
+
+  template <class Kernel>
+  unsigned int BasicTrapezoidalMap<Kernel>::trapezoids() const {
+    return _live;
+  }
+
+  template <class Kernel>
+  unsigned int BasicTrapezoidalMap<Kernel>::nodes() const {
+    return _node_count;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_TRAPEZOIDALMAP(K)		\
+  template class BasicTrapezoidalMap<K>;
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_TRAPEZOIDALMAP)
+}
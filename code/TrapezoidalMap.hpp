@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    TrapezoidalMap.hpp                                               //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: Solves the planar point location problem with a randomized       //
+//          incremental trapezoidal map and its search DAG, in expected      //
+//          O(n) space and O(log n) query time.                              //
+//                                                                           //
+// NOTES:   The segments must not cross or be vertical.  End points which    //
+//          share an x coordinate are told apart lexicographically, as if    //
+//          the plane were sheared slightly; each vertex then has its own    //
+//          vertical extension.                                              //
+//                                                                           //
+//          A query point p is located as if it were moved right by less     //
+//          than any gap between x coordinates, so a point on a vertical     //
+//          extension is placed in the trapezoid to its right.  Against a    //
+//          segment, p is placed by operator< on the segment (p,p), which    //
+//          puts a point on a segment above it.  This is how the slabs of    //
+//          BasicPolygonalSubdivision place such points.                     //
+//                                                                           //
+//          The trapezoids and the nodes of the DAG are allocated from an    //
+//          arena, which the owner of the map provides and which must        //
+//          outlive it, so that they are not freed one by one.  A map which  //
+//          is built again leaves its old ones in the arena.                 //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// BasicTrapezoidalMap(arena)           allocates from the arena             //
+// build(segments,count,seed)           builds the map over segments, which  //
+//                                      must outlive it, inserting them in   //
+//                                      an order drawn from seed             //
+// locate(p,above,below)                the indices of the top and bottom of //
+//                                      the trapezoid containing p, or NONE  //
+//                                      where it is unbounded                //
+// cells(out)                           the trapezoids of the map            //
+// trapezoids()                         the number of trapezoids in the map  //
+// nodes()                              the number of nodes in the DAG       //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef TRAPEZOIDALMAP_HPP
+#define TRAPEZOIDALMAP_HPP
+
+#include <vector>
+#include "Arena.hpp"
+#include "Point2D.hpp"
+#include "LineSegment.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicTrapezoidalMap {
+  public:
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    // the index of a segment, or NONE where a trapezoid is unbounded
+    static const unsigned int NONE = ~0u;
+
+    // A trapezoid, bounded by the segments of index top and bottom and
+    // by the vertical lines through leftp and rightp, which are 0 where
+    // it is unbounded and point into the segments.  Where two end points
+    // share an x coordinate, the trapezoid between them is empty.
+    struct Cell {
+      unsigned int top;
+      unsigned int bottom;
+      const point_t* leftp;
+      const point_t* rightp;
+    };
+
+    BasicTrapezoidalMap(memory::Arena& arena);
+    ~BasicTrapezoidalMap();
+
+    void build(const segment_t* segments,
+	       unsigned int count,
+	       unsigned long seed);
+    void locate(const point_t& p,
+		unsigned int& above,
+		unsigned int& below) const;
+    void cells(vector<Cell>& out) const;
+
+    unsigned int trapezoids() const;
+    unsigned int nodes() const;
+
+  private:
+    struct Node;
+
+    struct Trapezoid {
+      unsigned int top;
+      unsigned int bottom;
+      // 0 where unbounded
+      const point_t* leftp;
+      const point_t* rightp;
+      // the neighbours across the parts of the left and right sides above
+      // and below leftp and rightp, 0 where that part is empty
+      Trapezoid* upper_left;
+      Trapezoid* lower_left;
+      Trapezoid* upper_right;
+      Trapezoid* lower_right;
+      // the leaf of the DAG
+      Node* node;
+      bool live;
+    };
+
+    struct Node {
+      enum Kind { X_NODE, Y_NODE, LEAF };
+      Kind kind;
+      const point_t* point;
+      unsigned int segment;
+      Trapezoid* trapezoid;
+      // left and right of the point, or above and below the segment
+      Node* left;
+      Node* right;
+    };
+
+    static bool lexLess(const point_t& a, const point_t& b);
+    static void replaceLeft(Trapezoid* t, Trapezoid* from, Trapezoid* to);
+    static void replaceRight(Trapezoid* t, Trapezoid* from, Trapezoid* to);
+
+    void clear();
+    void insert(unsigned int segment);
+    Trapezoid* newTrapezoid(unsigned int top, unsigned int bottom,
+			    const point_t* leftp, const point_t* rightp);
+    Node* newNode();
+    Node* leaf(Trapezoid* t);
+    void setX(Node* n, const point_t* point, Node* left, Node* right);
+    void setY(Node* n, unsigned int segment, Node* above, Node* below);
+
+    // not copyable
+    BasicTrapezoidalMap(const BasicTrapezoidalMap&);
+    BasicTrapezoidalMap& operator=(const BasicTrapezoidalMap&);
+
+    memory::Arena& _arena;
+    const segment_t* _segments;
+    unsigned int _segment_count;
+    vector<Trapezoid*> _trapezoids;
+    unsigned int _node_count;
+    Node* _root;
+    unsigned int _live;
+  };
+}
+
+#endif
@@ -0,0 +1,619 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    TriangulationHierarchy.cpp                                       //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// NOTES:   Follows Kirkpatrick, Optimal search in planar subdivisions,      //
+//          SIAM J. Comput. 12(1), 1983.  The vertical decomposition is      //
+//          read from a BasicTrapezoidalMap, whose trapezoids do not depend  //
+//          on the order the segments were inserted in.                      //
+//                                                                           //
+//          Each trapezoid is split into a fan of triangles around its       //
+//          centroid, with a corner at every vertex on its boundary, so that //
+//          the triangles of neighbouring trapezoids meet edge to edge.      //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include "TriangulationHierarchy.hpp"
+#include "TrapezoidalMap.hpp"
+#include "SlabOrder.hpp"
+#include "Trace.hpp"
+
+namespace geometry {
+  /////////////////////////////////////////////////////////////////////////////
+  // BasicTriangulationHierarchy implementation                              //
+  /////////////////////////////////////////////////////////////////////////////
+  template <class Kernel>
+  BasicTriangulationHierarchy<Kernel>::BasicTriangulationHierarchy()
+    : _segments(0),
+      _segment_count(0),
+      _points(),
+      _triangles(),
+      _children(),
+      _top(),
+      _vertices(),
+      _vertex_offsets(),
+      _vertex_segments(),
+      _box_low(),
+      _box_high(),
+      _low(),
+      _high(),
+      _levels(0),
+      _around()
+  {
+  }
+
+  template <class Kernel>
+  bool BasicTriangulationHierarchy<Kernel>::lexLess(const point_t& a,
+						    const point_t& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  }
+
+  // the y coordinate of a non-vertical segment at x, exactly at its end
+  // points
+  template <class Kernel>
+  typename BasicTriangulationHierarchy<Kernel>::coord_t
+  BasicTriangulationHierarchy<Kernel>::heightAt(const segment_t& s,
+						const coord_t& x) {
+    const point_t& a = s.getLeftEndPoint();
+    const point_t& b = s.getRightEndPoint();
+    if(x == a.x)
+      return a.y;
+    if(x == b.x)
+      return b.y;
+    return a.y + (b.y - a.y) * (x - a.x) / (b.x - a.x);
+  }
+
+  // The orientation of a, b and p, with p moved right by e * e and up
+  // by e (down, if up is -1) for an arbitrarily small e.  Only the
+  // lowest power of e which does not cancel decides, so the result is
+  // never 0 unless a and b are the same point.  An edge is always
+  // tested in the same direction, so that the two triangles sharing it
+  // agree on which side of it p is, even where the kernel is inexact.
+  template <class Kernel>
+  int BasicTriangulationHierarchy<Kernel>::side(const point_t& a,
+						const point_t& b,
+						const point_t& p,
+						int up) {
+    if(lexLess(b,a))
+      return -side(b,a,p,up);
+    int turn = point_t::orientation(a,b,p);
+    if(turn != 0)
+      return turn;
+    if(a.x != b.x)
+      return a.x < b.x ? up : -up;
+    return b.y < a.y ? 1 : -1;
+  }
+
+  template <class Kernel>
+  unsigned int
+  BasicTriangulationHierarchy<Kernel>::indexOf(const vector<point_t>& sorted,
+					       const point_t& p) {
+    return int(lower_bound(sorted.begin(),sorted.end(),p,lexLess)
+	       - sorted.begin());
+  }
+
+  template <class Kernel>
+  bool BasicTriangulationHierarchy<Kernel>::corner(unsigned int vertex) const {
+    const point_t& p = _points[vertex];
+    return (p.x == _box_low.x || p.x == _box_high.x) &&
+      (p.y == _box_low.y || p.y == _box_high.y);
+  }
+
+  template <class Kernel>
+  bool BasicTriangulationHierarchy<Kernel>::boundary(unsigned int vertex) const {
+    const point_t& p = _points[vertex];
+    return p.x == _box_low.x || p.x == _box_high.x ||
+      p.y == _box_low.y || p.y == _box_high.y;
+  }
+
+  template <class Kernel>
+  void BasicTriangulationHierarchy<Kernel>::addTriangle(unsigned int a,
+							unsigned int b,
+							unsigned int c,
+							unsigned int top,
+							unsigned int bottom) {
+    Triangle t;
+    t.corner[0] = a;
+    t.corner[1] = b;
+    t.corner[2] = c;
+    t.first_child = 0;
+    t.children = 0;
+    t.top = top;
+    t.bottom = bottom;
+    _triangles.push_back(t);
+  }
+
+  // orders the indices of segments from the top, as the slabs do
+  template <class Segment>
+  class SegmentIndexOrder {
+  public:
+    SegmentIndexOrder(const Segment* segments)
+      : _segments(segments)
+    {}
+
+    bool operator()(unsigned int a, unsigned int b) const {
+      return BasicSlabOrder<typename Segment::kernel_t>::less(_segments[a],
+							     _segments[b]);
+    }
+
+  private:
+    const Segment* _segments;
+  };
+
+  template <class Kernel>
+  void BasicTriangulationHierarchy<Kernel>::build(const segment_t* segments,
+						  unsigned int count) {
+    if(!Kernel::is_field || !Kernel::is_exact)
+      throw string("The triangulation hierarchy needs an exact field kernel");
+
+    _segments = segments;
+    _segment_count = count;
+    _points.clear();
+    _triangles.clear();
+    _children.clear();
+    _top.clear();
+    _levels = 0;
+    if(_segment_count == 0)
+      return;
+
+    // the rectangle is two units clear of every end point
+    point_t low = _segments[0].getLeftEndPoint();
+    point_t high = low;
+    for(unsigned int i = 0; i < _segment_count; ++i) {
+      const point_t* ends[2] = { &_segments[i].getLeftEndPoint(),
+				 &_segments[i].getRightEndPoint() };
+      for(unsigned int j = 0; j < 2; ++j) {
+	if(ends[j]->x < low.x)
+	  low.x = ends[j]->x;
+	if(high.x < ends[j]->x)
+	  high.x = ends[j]->x;
+	if(ends[j]->y < low.y)
+	  low.y = ends[j]->y;
+	if(high.y < ends[j]->y)
+	  high.y = ends[j]->y;
+      }
+    }
+    coord_t one(1);
+    _low = point_t(low.x - one,low.y - one);
+    _high = point_t(high.x + one,high.y + one);
+    _box_low = point_t(_low.x - one,_low.y - one);
+    _box_high = point_t(_high.x + one,_high.y + one);
+
+    triangulateCells(_segments,_segment_count);
+    coarsen();
+
+    // the end points, each with the segments starting there
+    vector<point_t> ends;
+    ends.reserve(2 * _segment_count);
+    for(unsigned int i = 0; i < _segment_count; ++i) {
+      ends.push_back(_segments[i].getLeftEndPoint());
+      ends.push_back(_segments[i].getRightEndPoint());
+    }
+    sort(ends.begin(),ends.end(),lexLess);
+    ends.erase(unique(ends.begin(),ends.end()),ends.end());
+    _vertices.swap(ends);
+
+    _vertex_offsets.assign(_vertices.size() + 1,0);
+    for(unsigned int i = 0; i < _segment_count; ++i)
+      ++_vertex_offsets[indexOf(_vertices,_segments[i].getLeftEndPoint()) + 1];
+    for(unsigned int i = 0; i < _vertices.size(); ++i)
+      _vertex_offsets[i + 1] += _vertex_offsets[i];
+    _vertex_segments.resize(_segment_count);
+    vector<unsigned int> next(_vertex_offsets.begin(),_vertex_offsets.end() - 1);
+    for(unsigned int i = 0; i < _segment_count; ++i)
+      _vertex_segments[next[indexOf(_vertices,
+				    _segments[i].getLeftEndPoint())]++] = i;
+    for(unsigned int i = 0; i < _vertices.size(); ++i)
+      sort(_vertex_segments.begin() + _vertex_offsets[i],
+	   _vertex_segments.begin() + _vertex_offsets[i + 1],
+	   SegmentIndexOrder<segment_t>(_segments));
+
+    TRACE(TRACE_SWEEP,TRACE_INFO,
+	  "Triangulation hierarchy of " << _segment_count << " segments: "
+	  << _levels << " levels, " << _triangles.size() << " triangles");
+  }
+
+  template <class Kernel>
+  void
+  BasicTriangulationHierarchy<Kernel>::triangulateCells(const segment_t* segments,
+							unsigned int count) {
+    typedef typename BasicTrapezoidalMap<Kernel>::Cell cell_t;
+    typedef pair<unsigned int, unsigned int> entry_t;
+    const unsigned int UNBOUNDED = BasicTrapezoidalMap<Kernel>::NONE;
+
+    // the map is freed at once, as soon as its cells are read
+    vector<cell_t> cells;
+    {
+      memory::Arena arena;
+      BasicTrapezoidalMap<Kernel> map(arena);
+      map.build(segments,count,1);
+      map.cells(cells);
+    }
+
+    // the top and bottom of the rectangle follow the segments
+    const unsigned int top_line = count;
+    const unsigned int bottom_line = top_line + 1;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // The corners of each cell, clipped to the rectangle: top left, top
+    // right, bottom left and bottom right.  Together with the end points
+    // of the segments, these are all the vertices of the triangulation
+    // but the centroids.
+    ///////////////////////////////////////////////////////////////////////////
+    vector<point_t> corners;
+    corners.reserve(4 * cells.size());
+    vector<point_t> points;
+    points.reserve(6 * cells.size());
+    for(unsigned int i = 0; i < cells.size(); ++i) {
+      const cell_t& cell = cells[i];
+      coord_t left = cell.leftp ? cell.leftp->x : _box_low.x;
+      coord_t right = cell.rightp ? cell.rightp->x : _box_high.x;
+      coord_t top_left = cell.top == UNBOUNDED ?
+	_box_high.y : heightAt(segments[cell.top],left);
+      coord_t top_right = cell.top == UNBOUNDED ?
+	_box_high.y : heightAt(segments[cell.top],right);
+      coord_t bottom_left = cell.bottom == UNBOUNDED ?
+	_box_low.y : heightAt(segments[cell.bottom],left);
+      coord_t bottom_right = cell.bottom == UNBOUNDED ?
+	_box_low.y : heightAt(segments[cell.bottom],right);
+      corners.push_back(point_t(left,top_left));
+      corners.push_back(point_t(right,top_right));
+      corners.push_back(point_t(left,bottom_left));
+      corners.push_back(point_t(right,bottom_right));
+      points.insert(points.end(),corners.end() - 4,corners.end());
+      if(cell.leftp)
+	points.push_back(*cell.leftp);
+      if(cell.rightp)
+	points.push_back(*cell.rightp);
+    }
+    sort(points.begin(),points.end(),lexLess);
+    points.erase(unique(points.begin(),points.end()),points.end());
+
+    // the vertices on each segment and on the top and bottom of the
+    // rectangle, which are in x order since the points are
+    vector<entry_t> on_line;
+    on_line.reserve(4 * cells.size());
+    for(unsigned int i = 0; i < cells.size(); ++i) {
+      unsigned int top = cells[i].top == UNBOUNDED ? top_line : cells[i].top;
+      unsigned int bottom =
+	cells[i].bottom == UNBOUNDED ? bottom_line : cells[i].bottom;
+      on_line.push_back(entry_t(top,indexOf(points,corners[4 * i])));
+      on_line.push_back(entry_t(top,indexOf(points,corners[4 * i + 1])));
+      on_line.push_back(entry_t(bottom,indexOf(points,corners[4 * i + 2])));
+      on_line.push_back(entry_t(bottom,indexOf(points,corners[4 * i + 3])));
+    }
+    sort(on_line.begin(),on_line.end());
+    on_line.erase(unique(on_line.begin(),on_line.end()),on_line.end());
+
+    vector<point_t> centroids;
+    vector<unsigned int> polygon;
+    for(unsigned int i = 0; i < cells.size(); ++i) {
+      const cell_t& cell = cells[i];
+      // between two end points with the same x coordinate
+      if(cell.leftp && cell.rightp && cell.leftp->x == cell.rightp->x)
+	continue;
+      unsigned int top = cell.top == UNBOUNDED ? top_line : cell.top;
+      unsigned int bottom = cell.bottom == UNBOUNDED ? bottom_line : cell.bottom;
+      unsigned int top_left = indexOf(points,corners[4 * i]);
+      unsigned int top_right = indexOf(points,corners[4 * i + 1]);
+      unsigned int bottom_left = indexOf(points,corners[4 * i + 2]);
+      unsigned int bottom_right = indexOf(points,corners[4 * i + 3]);
+
+      // the boundary, counterclockwise from the bottom left corner; the
+      // vertices on a vertical side are consecutive in the points
+      polygon.clear();
+      typename vector<entry_t>::const_iterator first, last;
+      first = lower_bound(on_line.begin(),on_line.end(),
+			  entry_t(bottom,bottom_left));
+      last = upper_bound(on_line.begin(),on_line.end(),
+			 entry_t(bottom,bottom_right));
+      for(; first != last; ++first)
+	if(polygon.empty() || polygon.back() != first->second)
+	  polygon.push_back(first->second);
+      for(unsigned int v = bottom_right; v <= top_right; ++v)
+	if(polygon.back() != v)
+	  polygon.push_back(v);
+      first = lower_bound(on_line.begin(),on_line.end(),
+			  entry_t(top,top_left));
+      last = upper_bound(on_line.begin(),on_line.end(),
+			 entry_t(top,top_right));
+      while(last != first) {
+	--last;
+	if(polygon.back() != last->second)
+	  polygon.push_back(last->second);
+      }
+      for(unsigned int v = top_left + 1; v-- > bottom_left; )
+	if(polygon.back() != v)
+	  polygon.push_back(v);
+      if(polygon.front() == polygon.back())
+	polygon.pop_back();
+      assert(polygon.size() >= 3);
+
+      coord_t x(0), y(0);
+      for(unsigned int j = 0; j < polygon.size(); ++j) {
+	x = x + points[polygon[j]].x;
+	y = y + points[polygon[j]].y;
+      }
+      coord_t count(int(polygon.size()));
+      unsigned int centroid = points.size() + centroids.size();
+      centroids.push_back(point_t(x / count,y / count));
+
+      for(unsigned int j = 0; j < polygon.size(); ++j)
+	addTriangle(centroid,
+		    polygon[j],
+		    polygon[(j + 1) % polygon.size()],
+		    cell.top,
+		    cell.bottom);
+    }
+
+    _points.swap(points);
+    _points.insert(_points.end(),centroids.begin(),centroids.end());
+  }
+
+  // the neighbours of a vertex, counterclockwise; for a vertex on the
+  // side of the rectangle, from one side neighbour round to the other
+  template <class Kernel>
+  void BasicTriangulationHierarchy<Kernel>::ring(unsigned int vertex,
+						 vector<unsigned int>& out) const {
+    const vector<unsigned int>& fan = _around[vertex];
+    // each triangle of the fan gives the edge opposite the vertex
+    vector<unsigned int> from(fan.size()), to(fan.size());
+    for(unsigned int i = 0; i < fan.size(); ++i) {
+      const Triangle& t = _triangles[fan[i]];
+      unsigned int k = 0;
+      while(t.corner[k] != vertex)
+	++k;
+      from[i] = t.corner[(k + 1) % 3];
+      to[i] = t.corner[(k + 2) % 3];
+    }
+
+    unsigned int start = 0;
+    for(unsigned int i = 0; i < fan.size(); ++i) {
+      if(find(to.begin(),to.end(),from[i]) == to.end()) {
+	start = i;
+	break;
+      }
+    }
+
+    out.clear();
+    out.push_back(from[start]);
+    unsigned int current = start;
+    for(unsigned int i = 0; i < fan.size(); ++i) {
+      if(to[current] == from[start])
+	break;
+      out.push_back(to[current]);
+      unsigned int next = int(find(from.begin(),from.end(),to[current])
+			      - from.begin());
+      if(next == from.size())
+	break;
+      current = next;
+    }
+  }
+
+  // triangulates the hole a vertex leaves by clipping ears, linking
+  // each new triangle to all the triangles it replaces
+  template <class Kernel>
+  void BasicTriangulationHierarchy<Kernel>::fillHole(const vector<unsigned int>& polygon,
+						     const vector<unsigned int>& removed) {
+    unsigned int first_child = _children.size();
+    _children.insert(_children.end(),removed.begin(),removed.end());
+    unsigned int first = _triangles.size();
+
+    vector<unsigned int> left(polygon);
+    while(left.size() > 3) {
+      unsigned int n = left.size();
+      unsigned int ear = n;
+      for(unsigned int i = 0; i < n && ear == n; ++i) {
+	const point_t& a = _points[left[(i + n - 1) % n]];
+	const point_t& b = _points[left[i]];
+	const point_t& c = _points[left[(i + 1) % n]];
+	if(point_t::orientation(a,b,c) <= 0)
+	  continue;
+	ear = i;
+	for(unsigned int j = 0; j < n; ++j) {
+	  if(j == i || j == (i + n - 1) % n || j == (i + 1) % n)
+	    continue;
+	  const point_t& q = _points[left[j]];
+	  if(point_t::orientation(a,b,q) >= 0 &&
+	     point_t::orientation(b,c,q) >= 0 &&
+	     point_t::orientation(c,a,q) >= 0) {
+	    ear = n;
+	    break;
+	  }
+	}
+      }
+      if(ear == n)
+	throw string("Could not triangulate a hole of the hierarchy");
+      addTriangle(left[(ear + n - 1) % n],left[ear],left[(ear + 1) % n],
+		  NONE,NONE);
+      left.erase(left.begin() + ear);
+    }
+    if(point_t::orientation(_points[left[0]],_points[left[1]],
+			    _points[left[2]]) <= 0)
+      throw string("Could not triangulate a hole of the hierarchy");
+    addTriangle(left[0],left[1],left[2],NONE,NONE);
+
+    for(unsigned int i = first; i < _triangles.size(); ++i) {
+      _triangles[i].first_child = first_child;
+      _triangles[i].children = removed.size();
+    }
+  }
+
+  template <class Kernel>
+  void BasicTriangulationHierarchy<Kernel>::coarsen() {
+    _around.assign(_points.size(),vector<unsigned int>());
+    for(unsigned int i = 0; i < _triangles.size(); ++i)
+      for(unsigned int k = 0; k < 3; ++k)
+	_around[_triangles[i].corner[k]].push_back(i);
+    vector<char> alive(_triangles.size(),1);
+    _levels = 1;
+
+    vector<char> blocked;
+    vector<unsigned int> chosen, polygon, removed;
+    for(;;) {
+      ///////////////////////////////////////////////////////////////////////
+      // Choose vertices of low degree, none next to another.  At least a
+      // third of the vertices of a planar triangulation have degree 8 or
+      // less, so a constant fraction is removed on each level.  Should
+      // none qualify, the vertex of least degree is removed instead.
+      ///////////////////////////////////////////////////////////////////////
+      chosen.clear();
+      blocked.assign(_points.size(),0);
+      unsigned int fallback = NONE;
+      unsigned int fallback_degree = 0;
+      for(unsigned int v = 0; v < _points.size(); ++v) {
+	if(_around[v].empty() || corner(v))
+	  continue;
+	unsigned int degree = _around[v].size() + (boundary(v) ? 1 : 0);
+	if(fallback == NONE || degree < fallback_degree) {
+	  fallback = v;
+	  fallback_degree = degree;
+	}
+	if(blocked[v] || degree > MAX_DEGREE)
+	  continue;
+	chosen.push_back(v);
+	for(unsigned int i = 0; i < _around[v].size(); ++i)
+	  for(unsigned int k = 0; k < 3; ++k)
+	    blocked[_triangles[_around[v][i]].corner[k]] = 1;
+      }
+      if(fallback == NONE)
+	break;
+      if(chosen.empty())
+	chosen.push_back(fallback);
+
+      for(unsigned int i = 0; i < chosen.size(); ++i) {
+	unsigned int v = chosen[i];
+	ring(v,polygon);
+	removed.swap(_around[v]);
+	_around[v].clear();
+	for(unsigned int j = 0; j < removed.size(); ++j) {
+	  const Triangle& t = _triangles[removed[j]];
+	  alive[removed[j]] = 0;
+	  for(unsigned int k = 0; k < 3; ++k) {
+	    if(t.corner[k] == v)
+	      continue;
+	    vector<unsigned int>& fan = _around[t.corner[k]];
+	    fan.erase(find(fan.begin(),fan.end(),removed[j]));
+	  }
+	}
+	unsigned int first = _triangles.size();
+	fillHole(polygon,removed);
+	alive.resize(_triangles.size(),1);
+	for(unsigned int j = first; j < _triangles.size(); ++j)
+	  for(unsigned int k = 0; k < 3; ++k)
+	    _around[_triangles[j].corner[k]].push_back(j);
+      }
+      ++_levels;
+    }
+
+    for(unsigned int i = 0; i < _triangles.size(); ++i)
+      if(alive[i])
+	_top.push_back(i);
+    vector< vector<unsigned int> >().swap(_around);
+  }
+
+  template <class Kernel>
+  bool BasicTriangulationHierarchy<Kernel>::contains(const Triangle& t,
+						     const point_t& p,
+						     int up) const {
+    const point_t& a = _points[t.corner[0]];
+    const point_t& b = _points[t.corner[1]];
+    const point_t& c = _points[t.corner[2]];
+    return side(a,b,p,up) > 0 && side(b,c,p,up) > 0 && side(c,a,p,up) > 0;
+  }
+
+  // the triangle of the finest level containing p, moved as side() moves
+  // it, which lies in exactly one triangle of each level
+  template <class Kernel>
+  unsigned int BasicTriangulationHierarchy<Kernel>::descend(const point_t& p,
+							    int up) const {
+    unsigned int found = NONE;
+    for(unsigned int i = 0; i < _top.size() && found == NONE; ++i)
+      if(contains(_triangles[_top[i]],p,up))
+	found = _top[i];
+    while(found != NONE && _triangles[found].children) {
+      const Triangle& t = _triangles[found];
+      found = NONE;
+      for(unsigned int i = 0; i < t.children && found == NONE; ++i)
+	if(contains(_triangles[_children[t.first_child + i]],p,up))
+	  found = _children[t.first_child + i];
+    }
+    if(found == NONE)
+      throw "Point not found in the triangulation hierarchy";
+    return found;
+  }
+
+  template <class Kernel>
+  void BasicTriangulationHierarchy<Kernel>::locate(const point_t& p,
+						   unsigned int& above,
+						   unsigned int& below) const {
+    above = below = NONE;
+    if(_segment_count == 0)
+      return;
+
+    // moved inside the rectangle, but no further past the segments
+    point_t q(p.x < _low.x ? _low.x : (_high.x < p.x ? _high.x : p.x),
+	      p.y < _low.y ? _low.y : (_high.y < p.y ? _high.y : p.y));
+
+    typename vector<point_t>::const_iterator vertex =
+      lower_bound(_vertices.begin(),_vertices.end(),p,lexLess);
+    if(vertex == _vertices.end() || !(*vertex == p)) {
+      const Triangle& t = _triangles[descend(q,1)];
+      above = t.top;
+      below = t.bottom;
+      return;
+    }
+
+    // p is an end point, so the segments starting there lie between
+    // those of the triangles just above and just below it
+    unsigned int i = vertex - _vertices.begin();
+    unsigned int begin = _vertex_offsets[i];
+    unsigned int end = _vertex_offsets[i + 1];
+    unsigned int low = begin, high = end;
+    while(low < high) {
+      unsigned int middle = low + (high - low) / 2;
+      if(BasicSlabOrder<Kernel>::less(p,_segments[_vertex_segments[middle]]))
+	high = middle;
+      else
+	low = middle + 1;
+    }
+    if(low > begin) {
+      above = _vertex_segments[low - 1];
+    } else {
+      above = _triangles[descend(q,1)].top;
+    }
+    if(low < end) {
+      below = _vertex_segments[low];
+    } else {
+      below = _triangles[descend(q,-1)].bottom;
+    }
+  }
+
+  template <class Kernel>
+  unsigned int BasicTriangulationHierarchy<Kernel>::triangles() const {
+    return _triangles.size();
+  }
+
+  template <class Kernel>
+  unsigned int BasicTriangulationHierarchy<Kernel>::levels() const {
+    return _levels;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Instantiations for the built-in kernels                                 //
+  /////////////////////////////////////////////////////////////////////////////
+#define INSTANTIATE_TRIANGULATIONHIERARCHY(K)		\
+  template class BasicTriangulationHierarchy<K>;
+
+  GEOMETRY_FOR_EACH_KERNEL(INSTANTIATE_TRIANGULATIONHIERARCHY)
+}
@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    TriangulationHierarchy.hpp                                       //
+//                                                                           //
+// MODULE:  Planar Point Location                                            //
+//                                                                           //
+// PURPOSE: Solves the planar point location problem with Kirkpatrick's      //
+//          triangulation hierarchy, in O(n) space and O(log n) query time   //
+//          in the worst case.                                               //
+//                                                                           //
+// NOTES:   The segments must not cross or be vertical, and the kernel must  //
+//          be an exact field (see Kernel.hpp), since the finest             //
+//          triangulation has vertices where vertical lines meet the         //
+//          segments.  Rounded, those vertices no longer lie on the segments //
+//          they were cut from, so a point on such a segment could be        //
+//          placed on the wrong side of it; build() refuses DoubleKernel as  //
+//          well as Int64Kernel.                                             //
+//                                                                           //
+//          The finest triangulation refines the vertical decomposition of   //
+//          the segments, clipped to a rectangle around them, so that each   //
+//          of its triangles lies between one pair of segments.  Each        //
+//          coarser level removes an independent set of vertices of degree   //
+//          at most 8 and triangulates the holes they leave, until only the  //
+//          corners of the rectangle are left.                               //
+//                                                                           //
+//          A query point p is located as if it were moved right by less     //
+//          than any gap between x coordinates, and then up by less than     //
+//          any gap between the segments there.  This is how the slabs of    //
+//          BasicPolygonalSubdivision place such points, except at the end   //
+//          points of the segments, where they are placed by operator< on    //
+//          the segment (p,p) among the segments starting there.             //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// build(segments,count)                builds the hierarchy over segments,  //
+//                                      which must outlive it                //
+// locate(p,above,below)                the indices of the segments above    //
+//                                      and below p, or NONE where there are //
+//                                      none                                 //
+// triangles()                          the number of triangles, on all      //
+//                                      levels                               //
+// levels()                             the number of levels                 //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef TRIANGULATIONHIERARCHY_HPP
+#define TRIANGULATIONHIERARCHY_HPP
+
+#include <vector>
+#include "Point2D.hpp"
+#include "LineSegment.hpp"
+
+using namespace std;
+
+namespace geometry {
+
+  template <class Kernel>
+  class BasicTriangulationHierarchy {
+  public:
+    typedef typename Kernel::coord_t coord_t;
+    typedef BasicPoint2D<Kernel> point_t;
+    typedef BasicLineSegment<Kernel> segment_t;
+
+    BasicTriangulationHierarchy();
+
+    // the index of a segment, or NONE where a triangle is unbounded
+    static const unsigned int NONE = ~0u;
+
+    void build(const segment_t* segments, unsigned int count);
+    void locate(const point_t& p,
+		unsigned int& above,
+		unsigned int& below) const;
+
+    unsigned int triangles() const;
+    unsigned int levels() const;
+
+  private:
+    // the largest degree of a vertex removed between levels
+    static const unsigned int MAX_DEGREE = 8;
+
+    struct Triangle {
+      // the indices of the corners, counterclockwise
+      unsigned int corner[3];
+      // the triangles of the finer level which this one replaced, at
+      // _children[first_child..first_child + children)
+      unsigned int first_child;
+      unsigned int children;
+      // for the triangles of the finest level, the segments above and
+      // below them
+      unsigned int top;
+      unsigned int bottom;
+    };
+
+    static bool lexLess(const point_t& a, const point_t& b);
+    static coord_t heightAt(const segment_t& s, const coord_t& x);
+    static int side(const point_t& a, const point_t& b,
+		    const point_t& p, int up);
+
+    static unsigned int indexOf(const vector<point_t>& sorted,
+				const point_t& p);
+    void triangulateCells(const segment_t* segments, unsigned int count);
+    void coarsen();
+    bool corner(unsigned int vertex) const;
+    bool boundary(unsigned int vertex) const;
+    void ring(unsigned int vertex, vector<unsigned int>& out) const;
+    void fillHole(const vector<unsigned int>& polygon,
+		  const vector<unsigned int>& removed);
+    void addTriangle(unsigned int a, unsigned int b, unsigned int c,
+		     unsigned int top, unsigned int bottom);
+
+    bool contains(const Triangle& t, const point_t& p, int up) const;
+    unsigned int descend(const point_t& p, int up) const;
+
+    const segment_t* _segments;
+    unsigned int _segment_count;
+    vector<point_t> _points;
+    vector<Triangle> _triangles;
+    vector<unsigned int> _children;
+    // the triangles of the coarsest level
+    vector<unsigned int> _top;
+    // the end points of the segments in lexicographic order, each with
+    // the segments starting there, from the top, at
+    // _vertex_segments[_vertex_offsets[i].._vertex_offsets[i + 1])
+    vector<point_t> _vertices;
+    vector<unsigned int> _vertex_offsets;
+    vector<unsigned int> _vertex_segments;
+    // the corners of the rectangle, and the part of it, clear of the
+    // segments, which queries are moved into
+    point_t _box_low;
+    point_t _box_high;
+    point_t _low;
+    point_t _high;
+    unsigned int _levels;
+
+    // the triangles around each vertex, while coarsening
+    vector< vector<unsigned int> > _around;
+  };
+}
+
+#endif
@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Generators.cpp                                                   //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   None.                                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include "Generators.hpp"
+
+namespace bench {
+  /////////////////////////////////////////////////////////////////////////////
+  // Random implementation                                                   //
+  /////////////////////////////////////////////////////////////////////////////
+  Random::Random(uint32_t seed)
+    : _state(seed ? seed : 1)
+  {
+  }
+
+  uint32_t Random::next() {
+    _state ^= _state << 13;
+    _state ^= _state >> 17;
+    _state ^= _state << 5;
+    return _state;
+  }
+
+  int Random::uniform(int low, int high) {
+    return low + int(next() % uint32_t(high - low + 1));
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Lattices                                                                //
+  /////////////////////////////////////////////////////////////////////////////
+  // the spacing of the jittered lattices
+  static const int SPACING = 1000;
+  static const int JITTER = SPACING / 5 - 1;
+
+  // the side of a square lattice with about segments / per_cell cells
+  static int side(unsigned int segments, double per_cell) {
+    int cells = int(sqrt(segments / per_cell) + 0.5);
+    return cells < 1 ? 1 : cells;
+  }
+
+  // the vertices of a lattice of (columns + 1) x (rows + 1) points,
+  // each moved by up to JITTER in x and y
+  static void jittered(int columns, int rows, Random& random,
+		       vector< vector<Point2D> >& out) {
+    out.assign(columns + 1,vector<Point2D>(rows + 1));
+    for(int i = 0; i <= columns; ++i)
+      for(int j = 0; j <= rows; ++j)
+	out[i][j] = Point2D(i * SPACING + random.uniform(-JITTER,JITTER),
+			    j * SPACING + random.uniform(-JITTER,JITTER));
+  }
+
+  static void bound(int columns, int rows, Subdivision& out) {
+    out.width = columns * SPACING + JITTER;
+    out.height = rows * SPACING + JITTER;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Shapes                                                                  //
+  /////////////////////////////////////////////////////////////////////////////
+  void grid(unsigned int segments, uint32_t, Subdivision& out) {
+    const int size = 16;
+    int cells = side(segments,2);
+    out.segments.clear();
+    for(int i = 0; i <= cells; ++i) {
+      for(int j = 0; j < cells; ++j) {
+	out.segments.push_back(LineSegment(j * size, i * size,
+					   (j + 1) * size, i * size));
+	out.segments.push_back(LineSegment(i * size, j * size,
+					   i * size, (j + 1) * size));
+      }
+    }
+    out.width = out.height = cells * size;
+  }
+
+  void triangulation(unsigned int segments, uint32_t seed, Subdivision& out) {
+    Random random(seed);
+    int cells = side(segments,3);
+    vector< vector<Point2D> > p;
+    jittered(cells,cells,random,p);
+    out.segments.clear();
+    for(int i = 0; i <= cells; ++i) {
+      for(int j = 0; j <= cells; ++j) {
+	if(i < cells)
+	  out.segments.push_back(LineSegment(p[i][j],p[i + 1][j]));
+	if(j < cells)
+	  out.segments.push_back(LineSegment(p[i][j],p[i][j + 1]));
+	if(i < cells && j < cells) {
+	  if(random.next() & 1)
+	    out.segments.push_back(LineSegment(p[i][j],p[i + 1][j + 1]));
+	  else
+	    out.segments.push_back(LineSegment(p[i + 1][j],p[i][j + 1]));
+	}
+      }
+    }
+    bound(cells,cells,out);
+  }
+
+  void voronoi(unsigned int segments, uint32_t seed, Subdivision& out) {
+    Random random(seed);
+    int cells = side(segments,1.5);
+    vector< vector<Point2D> > p;
+    jittered(cells,cells,random,p);
+    out.segments.clear();
+    // rows of edges, joined in alternate columns like the bricks of a
+    // wall, which gives hexagons
+    for(int j = 0; j <= cells; ++j) {
+      for(int i = 0; i <= cells; ++i) {
+	if(i < cells)
+	  out.segments.push_back(LineSegment(p[i][j],p[i + 1][j]));
+	if(j < cells && (i + j) % 2 == 0)
+	  out.segments.push_back(LineSegment(p[i][j],p[i][j + 1]));
+      }
+    }
+    bound(cells,cells,out);
+  }
+
+  void roads(unsigned int segments, uint32_t seed, Subdivision& out) {
+    // each road is 16 times as long as the width of all of them, and
+    // has a cross street at one vertex in 8
+    const int gap = 100;
+    const int jitter = gap / 5 - 1;
+    Random random(seed);
+    int count = side(segments,18);
+    int length = 16 * count;
+    vector< vector<Point2D> > p(count,vector<Point2D>(length + 1));
+    for(int r = 0; r < count; ++r)
+      for(int k = 0; k <= length; ++k)
+	p[r][k] = Point2D(k * SPACING,
+			  jitter + r * gap + random.uniform(-jitter,jitter));
+    out.segments.clear();
+    for(int r = 0; r < count; ++r) {
+      for(int k = 0; k <= length; ++k) {
+	if(k < length)
+	  out.segments.push_back(LineSegment(p[r][k],p[r][k + 1]));
+	if(r + 1 < count && random.next() % 8 == 0)
+	  out.segments.push_back(LineSegment(p[r][k],p[r + 1][k]));
+      }
+    }
+    out.width = length * SPACING;
+    out.height = 2 * jitter + (count - 1) * gap;
+  }
+
+  void rectilinear(unsigned int segments, uint32_t seed, Subdivision& out) {
+    Random random(seed);
+    int cells = side(segments,1);
+    vector<int> x(cells + 1,0), y(cells + 1,0);
+    for(int i = 1; i <= cells; ++i) {
+      x[i] = x[i - 1] + random.uniform(SPACING / 2,3 * SPACING / 2);
+      y[i] = y[i - 1] + random.uniform(SPACING / 2,3 * SPACING / 2);
+    }
+    out.segments.clear();
+    for(int i = 0; i <= cells; ++i) {
+      for(int j = 0; j < cells; ++j) {
+	// the outer edges are always kept
+	bool outer = i == 0 || i == cells;
+	if(outer || random.next() & 1)
+	  out.segments.push_back(LineSegment(x[j],y[i],x[j + 1],y[i]));
+	if(outer || random.next() & 1)
+	  out.segments.push_back(LineSegment(x[i],y[j],x[i],y[j + 1]));
+      }
+    }
+    out.width = x[cells];
+    out.height = y[cells];
+  }
+
+  const Shape SHAPES[] = {
+    { "grid", grid },
+    { "triangulation", triangulation },
+    { "voronoi", voronoi },
+    { "roads", roads },
+    { "rectilinear", rectilinear }
+  };
+
+  const unsigned int SHAPE_COUNT = sizeof(SHAPES) / sizeof(SHAPES[0]);
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Queries                                                                 //
+  /////////////////////////////////////////////////////////////////////////////
+  void queries(const Subdivision& subdivision,
+	       unsigned int count,
+	       uint32_t seed,
+	       vector<Point2D>& out) {
+    Random random(seed);
+    out.clear();
+    out.reserve(count);
+    for(unsigned int i = 0; i < count; ++i)
+      out.push_back(Point2D(random.uniform(0,subdivision.width),
+			    random.uniform(0,subdivision.height)));
+  }
+
+  void track(const Subdivision& subdivision,
+	     unsigned int count,
+	     uint32_t seed,
+	     vector<Point2D>& out) {
+    Random random(seed);
+    int dx = subdivision.width / 1000 > 1 ? subdivision.width / 1000 : 1;
+    int dy = subdivision.height / 1000 > 1 ? subdivision.height / 1000 : 1;
+    int x = random.uniform(0,subdivision.width);
+    int y = random.uniform(0,subdivision.height);
+    out.clear();
+    out.reserve(count);
+    for(unsigned int i = 0; i < count; ++i) {
+      out.push_back(Point2D(x,y));
+      // steps off the edge are turned back
+      x += random.uniform(-dx,dx);
+      y += random.uniform(-dy,dy);
+      x = x < 0 ? -x : x > subdivision.width ? 2 * subdivision.width - x : x;
+      y = y < 0 ? -y : y > subdivision.height ? 2 * subdivision.height - y : y;
+    }
+  }
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Generators.hpp                                                   //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// PURPOSE: Synthetic polygonal subdivisions of several shapes, and query    //
+//          points for them.                                                 //
+//                                                                           //
+// NOTES:   The generators use their own random numbers, so the same seed    //
+//          gives the same subdivision on every machine.  Each makes about   //
+//          the number of segments asked for, with integer end points in     //
+//          [0,width] x [0,height], none of them crossing.                   //
+//                                                                           //
+//          Jittered vertices move less than a fifth of the lattice spacing, //
+//          which keeps every cell of the lattice convex, so the edges and   //
+//          diagonals between them cannot cross.                             //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// Random(seed)                         a generator of random numbers        //
+// next()                               the next 32 random bits              //
+// uniform(low,high)                    an integer in [low,high]             //
+// SHAPES[i].generate(n,seed,out)       a subdivision of the i-th shape,     //
+//                                      for i < SHAPE_COUNT                  //
+// queries(subdivision,n,seed,out)      n points in its bounding box         //
+// track(subdivision,n,seed,out)        n points of a random walk in it,     //
+//                                      like the positions of a vehicle      //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef GENERATORS_HPP
+#define GENERATORS_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+
+using namespace std;
+using geometry::Point2D;
+using geometry::LineSegment;
+
+namespace bench {
+
+  // xorshift, with 32 bits of state
+  class Random {
+  public:
+    Random(uint32_t seed);
+
+    uint32_t next();
+    int uniform(int low, int high);
+
+  private:
+    uint32_t _state;
+  };
+
+  struct Subdivision {
+    vector<LineSegment> segments;
+    int width;
+    int height;
+  };
+
+  struct Shape {
+    const char* name;
+    void (*generate)(unsigned int segments,
+		     uint32_t seed,
+		     Subdivision& out);
+  };
+
+  // a grid of square cells, each side a separate segment
+  void grid(unsigned int segments, uint32_t seed, Subdivision& out);
+  // a jittered grid, each cell split by one of its diagonals
+  void triangulation(unsigned int segments, uint32_t seed, Subdivision& out);
+  // jittered hexagons, meeting three at each vertex like Voronoi cells
+  void voronoi(unsigned int segments, uint32_t seed, Subdivision& out);
+  // long, nearly horizontal roads close together, joined here and there
+  // by vertical cross streets
+  void roads(unsigned int segments, uint32_t seed, Subdivision& out);
+  // a grid of uneven rows and columns, about half of whose inner edges
+  // are left out, so that the cells are rectilinear polygons
+  void rectilinear(unsigned int segments, uint32_t seed, Subdivision& out);
+
+  extern const Shape SHAPES[];
+  extern const unsigned int SHAPE_COUNT;
+
+  void queries(const Subdivision& subdivision,
+	       unsigned int count,
+	       uint32_t seed,
+	       vector<Point2D>& out);
+
+  // each step is at most a thousandth of the width or height
+  void track(const Subdivision& subdivision,
+	     unsigned int count,
+	     uint32_t seed,
+	     vector<Point2D>& out);
+}
+
+#endif
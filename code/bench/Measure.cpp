@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Measure.cpp                                                      //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Each block is preceded by its size, so that operator delete can  //
+//          take it off heap_bytes.                                          //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <new>
+#include "Measure.hpp"
+
+namespace bench {
+  size_t heap_bytes = 0;
+  size_t heap_peak = 0;
+  unsigned long allocations = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Heap accounting                                                           //
+///////////////////////////////////////////////////////////////////////////////
+void* operator new(size_t size) throw(std::bad_alloc) {
+  size_t* block = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+  if(!block)
+    throw std::bad_alloc();
+  *block = size;
+  ++bench::allocations;
+  bench::heap_bytes += size;
+  if(bench::heap_peak < bench::heap_bytes)
+    bench::heap_peak = bench::heap_bytes;
+  return block + 1;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+  return operator new(size);
+}
+
+void operator delete(void* p) throw() {
+  if(!p)
+    return;
+  size_t* block = static_cast<size_t*>(p) - 1;
+  bench::heap_bytes -= *block;
+  free(block);
+}
+
+void operator delete[](void* p) throw() {
+  operator delete(p);
+}
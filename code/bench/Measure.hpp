@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    Measure.hpp                                                      //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// PURPOSE: The clocks of the benchmarks, and an account of the heap.        //
+//                                                                           //
+// NOTES:   The clocks are inline, so a program which only times needs      //
+//          nothing more than this header.  The heap is only accounted in a  //
+//          program linked with Measure.o, which replaces the global         //
+//          operator new and delete with ones that keep the counts below.    //
+//          The counts are not synchronized, so they are only read where a   //
+//          single thread allocates.                                         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+// Public Methods:                      Description:                         //
+// ---------------                      ------------                         //
+// seconds()                            the wall clock, in seconds           //
+// nanoseconds()                        a monotonic clock, in nanoseconds,   //
+//                                      for spans well under a microsecond   //
+// heap_bytes                           the bytes allocated and not freed    //
+// heap_peak                            the largest heap_bytes since it was  //
+//                                      last set                             //
+// allocations                          the calls of operator new so far     //
+///////////////////////////////////////////////////////////////////////////////
+#ifndef MEASURE_HPP
+#define MEASURE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <sys/time.h>
+#include <time.h>
+
+namespace bench {
+
+  inline double seconds() {
+    timeval now;
+    gettimeofday(&now,0);
+    return now.tv_sec + now.tv_usec / 1e6;
+  }
+
+  inline int64_t nanoseconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec * int64_t(1000000000) + now.tv_nsec;
+  }
+
+  extern size_t heap_bytes;
+  extern size_t heap_peak;
+  extern unsigned long allocations;
+}
+
+#endif
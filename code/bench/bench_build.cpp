@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_build.cpp                                                  //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Generates each shape of Generators.hpp with the given number of  //
+//          segments, and prints the best of several times to lock() it      //
+//          with the persistent skip list, and the segments locked per       //
+//          second.  The adding of the segments is not timed.  Only the      //
+//          public interface is used, so that older builds may be measured   //
+//          the same way.                                                    //
+//                                                                           //
+//          usage: bench_build [segments] [runs]                             //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "Generators.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+using bench::Subdivision;
+
+int main(int argc, char** argv) {
+  unsigned int size = 1000000;
+  int runs = 3;
+  if(argc > 1)
+    size = atoi(argv[1]);
+  if(argc > 2)
+    runs = atoi(argv[2]);
+  if(runs < 1)
+    runs = 1;
+
+  cout << setw(14) << "shape" << setw(12) << "segments"
+       << setw(12) << "lock s" << setw(14) << "segments/s" << endl;
+  for(unsigned int s = 0; s < bench::SHAPE_COUNT; ++s) {
+    Subdivision subdivision;
+    bench::SHAPES[s].generate(size,size,subdivision);
+    const vector<LineSegment>& segments = subdivision.segments;
+
+    double best = 0;
+    for(int run = 0; run < runs; ++run) {
+      PolygonalSubdivision ps;
+      ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+      double start = seconds();
+      try {
+	ps.lock();
+      } catch(string str) {
+	cerr << bench::SHAPES[s].name << ": " << str << endl;
+	return 1;
+      }
+      double elapsed = seconds() - start;
+      if(run == 0 || elapsed < best)
+	best = elapsed;
+    }
+    cout << setw(14) << bench::SHAPES[s].name << setw(12) << segments.size()
+	 << setw(12) << best
+	 << setw(14) << long(segments.size() / best) << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_engines.cpp                                                //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Builds each engine of PolygonalSubdivision on the same segments  //
+//          and reports the time to lock, the heap bytes held afterwards,    //
+//          the time to locate the query points as a batch, the slowest of   //
+//          them located one at a time, the time to destroy it, and whether  //
+//          every engine gave the same answers.  A frozen subdivision is     //
+//          also saved and timed as it is loaded back, in place of the lock. //
+//                                                                           //
+//          usage: bench_engines [segments file] [points file]               //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "../SegmentReader.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+using bench::heap_bytes;
+
+///////////////////////////////////////////////////////////////////////////////
+// Measurements                                                              //
+///////////////////////////////////////////////////////////////////////////////
+// how a subdivision is readied for queries
+enum Preparation { LOCK, FREEZE, LOAD };
+
+const char* SNAPSHOT = "bench_snapshot.bin";
+
+void measure(const char* name,
+	     PolygonalSubdivision::Engine engine,
+	     Preparation preparation,
+	     const vector<LineSegment>& segments,
+	     const vector<Point2D>& points,
+	     vector<QueryResult>& results) {
+  if(preparation == LOAD) {
+    PolygonalSubdivision saved;
+    saved.addLineSegments(&segments[0],&segments[0] + segments.size());
+    saved.lock();
+    saved.freeze();
+    saved.save(SNAPSHOT);
+  }
+
+  size_t before = heap_bytes;
+  PolygonalSubdivision* ps = new PolygonalSubdivision(engine);
+  double start = 0;
+  if(preparation == LOAD) {
+    start = seconds();
+    ps->load(SNAPSHOT);
+  } else {
+    ps->addLineSegments(&segments[0],&segments[0] + segments.size());
+    start = seconds();
+    ps->lock();
+    if(preparation == FREEZE)
+      ps->freeze();
+  }
+  double lock_time = seconds() - start;
+  size_t bytes = heap_bytes - before;
+  if(preparation == LOAD)
+    remove(SNAPSHOT);
+
+  results.resize(points.size());
+  start = seconds();
+  if(!points.empty())
+    ps->locate_points(&points[0],&points[0] + points.size(),&results[0]);
+  double query_time = seconds() - start;
+
+  double worst = 0;
+  for(unsigned int i = 0; i < points.size(); ++i) {
+    start = seconds();
+    ps->locate_point(points[i]);
+    double elapsed = seconds() - start;
+    if(worst < elapsed)
+      worst = elapsed;
+  }
+
+  start = seconds();
+  delete ps;
+  double free_time = seconds() - start;
+
+  cout << setw(24) << name << setw(12) << lock_time
+       << setw(14) << bytes << setw(12) << query_time
+       << setw(12) << worst << setw(12) << free_time << endl;
+}
+
+int main(int argc, char** argv) {
+  if(argc < 3) {
+    cerr << "usage: " << argv[0] << " [segments file] [points file]" << endl;
+    return 0;
+  }
+  vector<LineSegment> segments;
+  try {
+    SegmentReader::read(argv[1],segments);
+  } catch(string str) {
+    cerr << str << endl;
+    return 1;
+  }
+  if(segments.empty()) {
+    cerr << "No line segments" << endl;
+    return 1;
+  }
+  vector<Point2D> points;
+  {
+    ifstream point_file(argv[2]);
+    istream_iterator<Point2D> begin(point_file), end;
+    points.assign(begin,end);
+  }
+  cout << segments.size() << " segments, " << points.size() << " queries"
+       << endl;
+  cout << setw(24) << "engine" << setw(12) << "lock s"
+       << setw(14) << "heap bytes" << setw(12) << "query s"
+       << setw(12) << "worst s" << setw(12) << "free s" << endl;
+
+  // the kernel may not support the hierarchy, which is then left out
+  bool with_hierarchy = PolygonalSubdivision::supports(
+    PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  vector<QueryResult> slabs, frozen, loaded, map, hierarchy;
+  try {
+    measure("persistent skip list",PolygonalSubdivision::PERSISTENT_SKIP_LIST,
+	    LOCK,segments,points,slabs);
+    measure("frozen slab index",PolygonalSubdivision::PERSISTENT_SKIP_LIST,
+	    FREEZE,segments,points,frozen);
+    measure("loaded snapshot",PolygonalSubdivision::PERSISTENT_SKIP_LIST,
+	    LOAD,segments,points,loaded);
+    measure("trapezoidal map",PolygonalSubdivision::TRAPEZOIDAL_MAP,
+	    LOCK,segments,points,map);
+    if(with_hierarchy)
+      measure("triangulation hierarchy",
+	      PolygonalSubdivision::TRIANGULATION_HIERARCHY,
+	      LOCK,segments,points,hierarchy);
+  } catch(string str) {
+    cerr << str << endl;
+    return 1;
+  } catch(const char* str) {
+    cerr << str << endl;
+    return 1;
+  }
+
+  for(unsigned int i = 0; i < points.size(); ++i) {
+    if(slabs[i] != frozen[i] || slabs[i] != loaded[i] ||
+       slabs[i] != map[i] || (with_hierarchy && slabs[i] != hierarchy[i])) {
+      cout << "engines disagree at (" << points[i] << ")" << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_interleaved.cpp                                            //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Generates a shape of Generators.hpp, by default the jittered     //
+//          triangulation, locks and freezes it, and prints the nanoseconds  //
+//          per query of random points located one at a time, as the test    //
+//          driver does, and by locate_points_interleaved with groups of     //
+//          each power of two up to the largest given.  The answers are      //
+//          compared with those located one at a time.                       //
+//                                                                           //
+//          usage: bench_interleaved [segments] [queries] [shape] [group]    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "Generators.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+using bench::Subdivision;
+
+int main(int argc, char** argv) {
+  unsigned int size = 1000000;
+  unsigned int count = 1000000;
+  unsigned int shape = 1;
+  unsigned int largest = 64;
+  if(argc > 1)
+    size = atoi(argv[1]);
+  if(argc > 2)
+    count = atoi(argv[2]);
+  if(argc > 3)
+    shape = atoi(argv[3]);
+  if(argc > 4)
+    largest = atoi(argv[4]);
+  if(shape >= bench::SHAPE_COUNT) {
+    cerr << "shape must be less than " << bench::SHAPE_COUNT << endl;
+    return 1;
+  }
+
+  Subdivision subdivision;
+  bench::SHAPES[shape].generate(size,size,subdivision);
+  const vector<LineSegment>& segments = subdivision.segments;
+  vector<Point2D> points;
+  bench::queries(subdivision,count,1,points);
+
+  PolygonalSubdivision ps;
+  ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+  try {
+    ps.lock();
+    ps.freeze();
+  } catch(string str) {
+    cerr << bench::SHAPES[shape].name << ": " << str << endl;
+    return 1;
+  } catch(const char* str) {
+    cerr << bench::SHAPES[shape].name << ": " << str << endl;
+    return 1;
+  }
+
+  vector<QueryResult> expected(points.size());
+  double start = seconds();
+  for(unsigned int i = 0; i < points.size(); ++i)
+    expected[i] = ps.locate_point(points[i]);
+  double single = (seconds() - start) * 1e9 / points.size();
+
+  cout << bench::SHAPES[shape].name << ", " << segments.size()
+       << " segments, " << points.size() << " queries" << endl;
+  cout << setw(10) << "group" << setw(12) << "ns/query"
+       << setw(10) << "speedup" << endl;
+  cout << setw(10) << "single" << setw(12) << single
+       << setw(10) << 1 << endl;
+
+  vector<QueryResult> results(points.size());
+  for(unsigned int group = 1; group <= largest; group *= 2) {
+    start = seconds();
+    ps.locate_points_interleaved(&points[0],
+				 &points[0] + points.size(),
+				 &results[0],
+				 group);
+    double interleaved = (seconds() - start) * 1e9 / points.size();
+    for(unsigned int i = 0; i < points.size(); ++i)
+      if(results[i] != expected[i]) {
+	cerr << "group " << group << ": wrong answer for query " << i << endl;
+	return 1;
+      }
+    cout << setw(10) << group << setw(12) << interleaved
+	 << setw(10) << single / interleaved << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_memory.cpp                                                 //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Reports the bytes used per line segment and per persistent skip  //
+//          list element, both for the compact LineSegment and for the old   //
+//          layout which stored six copies of its end points.                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../lib/PersistentSkipList/PersistentSkipList.hpp"
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::heap_bytes;
+
+///////////////////////////////////////////////////////////////////////////////
+// The layout LineSegment had before it was made compact                     //
+///////////////////////////////////////////////////////////////////////////////
+class LegacyLineSegment {
+public:
+  LegacyLineSegment() {}
+
+  LegacyLineSegment(const LineSegment& ls)
+    : first(ls.getFirstEndPoint()), second(ls.getSecondEndPoint()),
+      left(ls.getLeftEndPoint()), right(ls.getRightEndPoint()),
+      top(ls.getTopEndPoint()), bottom(ls.getBottomEndPoint())
+  {}
+
+  bool operator<(const LegacyLineSegment& other) const {
+    return LineSegment(first,second) < LineSegment(other.first,other.second);
+  }
+
+  bool operator==(const LegacyLineSegment& other) const {
+    return LineSegment(first,second) == LineSegment(other.first,other.second);
+  }
+
+  bool operator!=(const LegacyLineSegment& other) const {
+    return !operator==(other);
+  }
+
+private:
+  Point2D first, second, left, right, top, bottom;
+};
+
+ostream& operator<<(ostream& os, const LegacyLineSegment&) {
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Measurements                                                              //
+///////////////////////////////////////////////////////////////////////////////
+
+// heap bytes held by a vector of n segments
+template <class Segment>
+size_t vectorBytes(const vector<LineSegment>& segments) {
+  size_t before = heap_bytes;
+  size_t result;
+  {
+    vector<Segment> copy;
+    copy.reserve(segments.size());
+    for(unsigned int i = 0; i < segments.size(); ++i)
+      copy.push_back(Segment(segments[i]));
+    result = heap_bytes - before;
+  }
+  return result;
+}
+
+// heap bytes held by a persistent skip list into which the segments were
+// inserted one version at a time
+template <class Segment>
+size_t pslBytes(const vector<LineSegment>& segments) {
+  size_t before = heap_bytes;
+  size_t result;
+  {
+    PersistentSkipList<Segment> psl;
+    for(unsigned int i = 0; i < segments.size(); ++i) {
+      psl.insert(Segment(segments[i]));
+      psl.incTime();
+    }
+    result = heap_bytes - before;
+  }
+  return result;
+}
+
+template <class Segment>
+void report(const char* name, const vector<LineSegment>& segments) {
+  double n = segments.size();
+  cout << name << endl
+       << "\t sizeof:                  " << sizeof(Segment) << endl
+       << "\t bytes per segment:       "
+       << vectorBytes<Segment>(segments) / n << endl
+       << "\t bytes per PSL element:   "
+       << pslBytes<Segment>(segments) / n << endl;
+}
+
+int main(int argc, char** argv) {
+  int n = 1000;
+  if(argc > 1)
+    n = atoi(argv[1]);
+
+  // horizontal segments stacked on top of each other, with coordinates
+  // that are not all small so rationals need their own storage
+  vector<LineSegment> segments;
+  for(int i = 0; i < n; ++i)
+    segments.push_back(LineSegment(Point2D(coord_t(-i * 7919),coord_t(i)),
+				   Point2D(coord_t(i * 104729),coord_t(i))));
+
+  cout << n << " segments, sizeof(Point2D) = " << sizeof(Point2D) << endl;
+  report<LegacyLineSegment>("before (six end point copies)", segments);
+  report<LineSegment>("after (compact)", segments);
+  return 0;
+}
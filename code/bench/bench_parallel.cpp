@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_parallel.cpp                                               //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Locks a grid subdivision and locates one batch of random points  //
+//          in it with 1, 2, 4, ... threads up to the number of processors,  //
+//          and prints the times and the speedups over one thread.  The      //
+//          query points are denser towards the left, so the slabs are       //
+//          skewed.                                                          //
+//                                                                           //
+//          usage: bench_parallel [cells per side] [queries] [max threads]   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unistd.h>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "../ThreadPool.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+using concurrency::ThreadPool;
+
+// a grid of square cells, each side a separate segment
+void addGrid(PolygonalSubdivision& ps, int cells, int side) {
+  for(int i = 0; i <= cells; ++i) {
+    for(int j = 0; j < cells; ++j) {
+      ps.addLineSegment(LineSegment(j * side, i * side,
+				    (j + 1) * side, i * side));
+      ps.addLineSegment(LineSegment(i * side, j * side,
+				    i * side, (j + 1) * side));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  int cells = 100;
+  int queries = 1000000;
+  int max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if(argc > 1)
+    cells = atoi(argv[1]);
+  if(argc > 2)
+    queries = atoi(argv[2]);
+  if(argc > 3)
+    max_threads = atoi(argv[3]);
+  if(max_threads < 1)
+    max_threads = 1;
+
+  const int side = 1000;
+  PolygonalSubdivision ps;
+  addGrid(ps,cells,side);
+  double start = seconds();
+  ps.lock();
+  cout << "sequential lock: " << seconds() - start << "s for "
+       << 2 * cells * (cells + 1) << " segments" << endl;
+
+  // squaring a uniform variable puts more points in the left slabs
+  srand(1);
+  vector<Point2D> points(queries);
+  for(int i = 0; i < queries; ++i) {
+    double u = rand() / (RAND_MAX + 1.0);
+    points[i] = Point2D(coord_t(int(u * u * cells * side)),
+			coord_t(rand() % (cells * side)));
+  }
+  vector<QueryResult> results(queries);
+
+  cout << setw(8) << "threads" << setw(12) << "lock s"
+       << setw(10) << "speedup" << setw(12) << "query s"
+       << setw(14) << "queries/s" << setw(10) << "speedup" << endl;
+  double single_lock = 0;
+  double single = 0;
+  int threads = 1;
+  while(true) {
+    ThreadPool pool(threads);
+    double lock_time;
+    {
+      PolygonalSubdivision banded;
+      addGrid(banded,cells,side);
+      start = seconds();
+      banded.lock(pool);
+      lock_time = seconds() - start;
+    }
+    start = seconds();
+    ps.locate_points(&points[0],&points[0] + queries,&results[0],pool);
+    double elapsed = seconds() - start;
+    if(threads == 1) {
+      single_lock = lock_time;
+      single = elapsed;
+    }
+    cout << setw(8) << threads << setw(12) << lock_time
+	 << setw(10) << single_lock / lock_time << setw(12) << elapsed
+	 << setw(14) << long(queries / elapsed)
+	 << setw(10) << single / elapsed << endl;
+    if(threads == max_threads)
+      break;
+    // also measure the largest count when it is not a power of two
+    threads = threads * 2 < max_threads ? threads * 2 : max_threads;
+  }
+  return 0;
+}
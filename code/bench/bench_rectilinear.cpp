@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_rectilinear.cpp                                            //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Generates the grid and the rectilinear shapes of Generators.hpp, //
+//          whose vertical edges lie many to a line, and prints the time to  //
+//          lock and freeze each, and the nanoseconds per query of random    //
+//          points and of points on the vertical edges, which land on the    //
+//          sweep lines.  The points are located one at a time.              //
+//                                                                           //
+//          usage: bench_rectilinear [segments] [queries]                    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "Generators.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+using bench::Subdivision;
+
+// points inside the vertical edges, chosen at random
+void on_verticals(const Subdivision& subdivision,
+		  unsigned int count,
+		  uint32_t seed,
+		  vector<Point2D>& out) {
+  vector<const LineSegment*> verticals;
+  for(unsigned int i = 0; i < subdivision.segments.size(); ++i)
+    if(subdivision.segments[i].isVertical())
+      verticals.push_back(&subdivision.segments[i]);
+  out.clear();
+  if(verticals.empty())
+    return;
+  bench::Random random(seed);
+  for(unsigned int i = 0; i < count; ++i) {
+    const LineSegment& s =
+      *verticals[random.uniform(0,verticals.size() - 1)];
+    const Point2D& bottom = s.getBottomEndPoint();
+    const Point2D& top = s.getTopEndPoint();
+    out.push_back(Point2D(bottom.x,(bottom.y + top.y) / 2));
+  }
+}
+
+// nanoseconds per query
+double locate(const PolygonalSubdivision& ps, const vector<Point2D>& points) {
+  if(points.empty())
+    return 0;
+  unsigned long sum = 0;
+  double start = seconds();
+  for(unsigned int i = 0; i < points.size(); ++i)
+    sum += ps.locate_point(points[i]).above;
+  double elapsed = seconds() - start;
+  // so that the queries are not left out
+  if(sum == 1)
+    cerr << "";
+  return elapsed * 1e9 / points.size();
+}
+
+int main(int argc, char** argv) {
+  unsigned int size = 1000000;
+  unsigned int count = 1000000;
+  if(argc > 1)
+    size = atoi(argv[1]);
+  if(argc > 2)
+    count = atoi(argv[2]);
+
+  const unsigned int shapes[] = { 0, 4 };
+
+  cout << setw(14) << "shape" << setw(12) << "segments"
+       << setw(13) << "rectilinear" << setw(12) << "lock s"
+       << setw(12) << "freeze s" << setw(12) << "random ns"
+       << setw(14) << "vertical ns" << endl;
+  for(unsigned int i = 0; i < 2; ++i) {
+    const bench::Shape& shape = bench::SHAPES[shapes[i]];
+    Subdivision subdivision;
+    shape.generate(size,size,subdivision);
+    const vector<LineSegment>& segments = subdivision.segments;
+    vector<Point2D> random, vertical;
+    bench::queries(subdivision,count,1,random);
+    on_verticals(subdivision,count,2,vertical);
+
+    PolygonalSubdivision ps;
+    ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+    double start = seconds();
+    double locked, frozen;
+    try {
+      ps.lock();
+      locked = seconds() - start;
+      start = seconds();
+      ps.freeze();
+      frozen = seconds() - start;
+    } catch(string str) {
+      cerr << shape.name << ": " << str << endl;
+      return 1;
+    } catch(const char* str) {
+      cerr << shape.name << ": " << str << endl;
+      return 1;
+    }
+
+    cout << setw(14) << shape.name << setw(12) << segments.size()
+	 << setw(13) << (ps.rectilinear() ? "yes" : "no")
+	 << setw(12) << locked << setw(12) << frozen
+	 << setw(12) << locate(ps,random)
+	 << setw(14) << locate(ps,vertical) << endl;
+  }
+  return 0;
+}
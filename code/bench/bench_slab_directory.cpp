@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_slab_directory.cpp                                         //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Generates the given number of distinct sweep points, evenly      //
+//          spread and crowded towards the left, and prints the nanoseconds  //
+//          per lookup of random query coordinates with the slab directory   //
+//          and with upper_bound over the same points.  The two answers are  //
+//          compared for every query.                                        //
+//                                                                           //
+//          usage: bench_slab_directory [points] [queries]                   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "../SlabDirectory.hpp"
+#include "Generators.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+
+typedef DefaultKernel::coord_t coord_t;
+
+// the coordinates lie in [0,RANGE)
+static const double RANGE = 1e12;
+
+// a coordinate in [0,1), raised to the given power to crowd it left
+double sample(bench::Random& random, int power) {
+  double u = (random.next() + random.next() / 4294967296.0) / 4294967296.0;
+  double v = u;
+  for(int i = 1; i < power; ++i)
+    v *= u;
+  return v;
+}
+
+void generate(unsigned int size, int power, uint32_t seed,
+	      vector<coord_t>& out) {
+  bench::Random random(seed);
+  out.clear();
+  for(unsigned int i = 0; i < size; ++i)
+    out.push_back(coord_t((int64_t)(sample(random,power) * RANGE)));
+  sort(out.begin(),out.end());
+  out.erase(unique(out.begin(),out.end()),out.end());
+}
+
+int main(int argc, char** argv) {
+  unsigned int size = 1000000;
+  unsigned int count = 1000000;
+  if(argc > 1)
+    size = atoi(argv[1]);
+  if(argc > 2)
+    count = atoi(argv[2]);
+
+  const char* names[] = { "uniform", "skewed u^4", "skewed u^16" };
+  const int powers[] = { 1, 4, 16 };
+
+  cout << setw(14) << "points" << setw(12) << "count"
+       << setw(14) << "directory ns" << setw(16) << "upper_bound ns"
+       << endl;
+  for(int d = 0; d < 3; ++d) {
+    vector<coord_t> points, queries;
+    generate(size,powers[d],1,points);
+    generate(count,powers[d],2,queries);
+    random_shuffle(queries.begin(),queries.end());
+
+    BasicSlabDirectory<DefaultKernel> directory;
+    directory.build(&points[0],points.size());
+
+    unsigned long sum = 0;
+    double start = seconds();
+    for(size_t i = 0; i < queries.size(); ++i)
+      sum += directory.find(queries[i]);
+    double guessed = seconds() - start;
+
+    start = seconds();
+    for(size_t i = 0; i < queries.size(); ++i)
+      sum -= upper_bound(points.begin(),points.end(),queries[i])
+	- points.begin();
+    double searched = seconds() - start;
+
+    for(size_t i = 0; i < queries.size(); ++i)
+      if(directory.find(queries[i]) !=
+	 unsigned(upper_bound(points.begin(),points.end(),queries[i])
+		  - points.begin())) {
+	cerr << names[d] << ": wrong slab for query " << i << endl;
+	return 1;
+      }
+    if(sum != 0) {
+      cerr << names[d] << ": answers differ" << endl;
+      return 1;
+    }
+
+    cout << setw(14) << names[d] << setw(12) << points.size()
+	 << setw(14) << guessed * 1e9 / queries.size()
+	 << setw(16) << searched * 1e9 / queries.size() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_suite.cpp                                                  //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Generates each shape of Generators.hpp at several sizes, builds  //
+//          each engine on it, and writes one line of comma separated values //
+//          per run to standard output: the time to lock, the peak and final //
+//          heap bytes of the lock, the 50th, 99th and 99.9th percentiles of //
+//          the time to locate one point, and the points located per second  //
+//          as a batch.  Then a track is followed with a query cursor, and   //
+//          the median time and the fractions of its queries which needed no //
+//          search or searched only one slab are written.  The offline sweep //
+//          is measured by its peak heap bytes and the points it locates per //
+//          second.  The generators are seeded by the size, so every run of  //
+//          a build sees the same subdivisions and queries, and the output   //
+//          of two builds can be compared.                                   //
+//                                                                           //
+//          The sizes are 1000, 10000, ... up to the largest asked for.      //
+//                                                                           //
+//          usage: bench_suite [largest size] [queries]                      //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "Generators.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::heap_bytes;
+using bench::heap_peak;
+using bench::nanoseconds;
+using bench::Subdivision;
+
+///////////////////////////////////////////////////////////////////////////////
+// Measurements                                                              //
+///////////////////////////////////////////////////////////////////////////////
+struct Run {
+  const char* name;
+  PolygonalSubdivision::Engine engine;
+  bool freeze;
+};
+
+const Run RUNS[] = {
+  { "persistent_skip_list", PolygonalSubdivision::PERSISTENT_SKIP_LIST, false },
+  { "frozen_slab_index", PolygonalSubdivision::PERSISTENT_SKIP_LIST, true },
+  { "trapezoidal_map", PolygonalSubdivision::TRAPEZOIDAL_MAP, false },
+  { "triangulation_hierarchy",
+    PolygonalSubdivision::TRIANGULATION_HIERARCHY, false }
+};
+
+const unsigned int RUN_COUNT = sizeof(RUNS) / sizeof(RUNS[0]);
+
+// the time below which the given fraction of the sorted times lie
+int64_t percentile(const vector<int64_t>& sorted, double fraction) {
+  unsigned int i = (unsigned int)(fraction * sorted.size());
+  return sorted[i < sorted.size() ? i : sorted.size() - 1];
+}
+
+void measure(const char* shape,
+	     const Run& run,
+	     const Subdivision& subdivision,
+	     const vector<Point2D>& points,
+	     const vector<Point2D>& track) {
+  const vector<LineSegment>& segments = subdivision.segments;
+  size_t before = heap_bytes;
+  PolygonalSubdivision ps(run.engine);
+  ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+  heap_peak = heap_bytes;
+  int64_t start = nanoseconds();
+  ps.lock();
+  if(run.freeze)
+    ps.freeze();
+  int64_t lock_time = nanoseconds() - start;
+  size_t peak = heap_peak - before;
+  size_t bytes = heap_bytes - before;
+
+  vector<int64_t> latencies(points.size());
+  for(unsigned int i = 0; i < points.size(); ++i) {
+    start = nanoseconds();
+    ps.locate_point(points[i]);
+    latencies[i] = nanoseconds() - start;
+  }
+  sort(latencies.begin(),latencies.end());
+
+  vector<QueryResult> results(points.size());
+  start = nanoseconds();
+  ps.locate_points(&points[0],&points[0] + points.size(),&results[0]);
+  int64_t batch_time = nanoseconds() - start;
+
+  // the track, each query starting from where the last one ended
+  QueryCursor cursor;
+  vector<int64_t> track_latencies(track.size());
+  for(unsigned int i = 0; i < track.size(); ++i) {
+    start = nanoseconds();
+    ps.locate_point(track[i],cursor);
+    track_latencies[i] = nanoseconds() - start;
+  }
+  sort(track_latencies.begin(),track_latencies.end());
+
+  cout << shape << ',' << run.name << ',' << segments.size() << ','
+       << points.size() << ',' << lock_time / 1e9 << ','
+       << peak << ',' << bytes << ','
+       << percentile(latencies,0.5) << ','
+       << percentile(latencies,0.99) << ','
+       << percentile(latencies,0.999) << ','
+       << (int64_t)(points.size() / (batch_time / 1e9 + 1e-9)) << ','
+       << percentile(track_latencies,0.5) << ','
+       << double(cursor.hits) / track.size() << ','
+       << double(cursor.near_hits) / track.size() << endl;
+}
+
+// The offline sweep has no lock, and its queries are only timed as a
+// batch, so the other columns are left empty.  Its peak is that of the sweep.
+void measure_offline(const char* shape,
+		     const Subdivision& subdivision,
+		     const vector<Point2D>& points) {
+  const vector<LineSegment>& segments = subdivision.segments;
+  size_t before = heap_bytes;
+  PolygonalSubdivision ps;
+  ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+  vector<QueryResult> results(points.size());
+  heap_peak = heap_bytes;
+  int64_t start = nanoseconds();
+  ps.locate_points_offline(&points[0],&points[0] + points.size(),&results[0]);
+  int64_t batch_time = nanoseconds() - start;
+  size_t peak = heap_peak - before;
+
+  cout << shape << ",offline_sweep," << segments.size() << ','
+       << points.size() << ",," << peak << ",,,,,"
+       << (int64_t)(points.size() / (batch_time / 1e9 + 1e-9)) << ",,,"
+       << endl;
+}
+
+int main(int argc, char** argv) {
+  unsigned int largest = 100000;
+  unsigned int queries = 100000;
+  if(argc > 1)
+    largest = atoi(argv[1]);
+  if(argc > 2)
+    queries = atoi(argv[2]);
+  if(queries < 1)
+    queries = 1;
+
+  cout << "shape,engine,segments,queries,lock_s,lock_peak_bytes,"
+       << "heap_bytes,p50_ns,p99_ns,p999_ns,queries_per_s,"
+       << "track_p50_ns,track_hit_rate,track_near_hit_rate" << endl;
+  for(unsigned int size = 1000; size <= largest; size *= 10) {
+    for(unsigned int s = 0; s < bench::SHAPE_COUNT; ++s) {
+      Subdivision subdivision;
+      bench::SHAPES[s].generate(size,size,subdivision);
+      vector<Point2D> points;
+      bench::queries(subdivision,queries,size + 1,points);
+      vector<Point2D> track;
+      bench::track(subdivision,queries,size + 2,track);
+      for(unsigned int r = 0; r < RUN_COUNT; ++r) {
+	if(!PolygonalSubdivision::supports(RUNS[r].engine))
+	  continue;
+	try {
+	  measure(bench::SHAPES[s].name,RUNS[r],subdivision,points,track);
+	} catch(string str) {
+	  cerr << bench::SHAPES[s].name << ' ' << RUNS[r].name << ": "
+	       << str << endl;
+	  return 1;
+	}
+      }
+      measure_offline(bench::SHAPES[s].name,subdivision,points);
+    }
+    // stop before the size wraps around
+    if(size > largest / 10)
+      break;
+  }
+  return 0;
+}
+
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    bench_update.cpp                                                 //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Generates a shape of Generators.hpp, by default the jittered     //
+//          triangulation, locks and freezes it, and then, for batches of    //
+//          each power of ten up to the largest given, removes the segments  //
+//          nearest a random point with one update and adds them back with   //
+//          another.  Prints the seconds each update took against those of   //
+//          locking and freezing the whole subdivision again, and the        //
+//          nanoseconds per query of random points afterwards.  The segments //
+//          above and below each point are compared with those found first.  //
+//                                                                           //
+//          usage: bench_update [segments] [queries] [shape] [batch]         //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "Generators.hpp"
+#include "Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::seconds;
+using bench::Subdivision;
+
+// the segment of a handle, which is NONE in both or neither
+bool sameSegment(const PolygonalSubdivision& a, unsigned int s,
+		 const PolygonalSubdivision& b, unsigned int t) {
+  if(s == PolygonalSubdivision::NONE || t == PolygonalSubdivision::NONE)
+    return s == t;
+  return a.segment(s) == b.segment(t);
+}
+
+// the batch segments whose left end points lie nearest a random point
+void window(const Subdivision& subdivision,
+	    unsigned int batch,
+	    bench::Random& random,
+	    vector<LineSegment>& out) {
+  const vector<LineSegment>& segments = subdivision.segments;
+  double x = random.uniform(0,subdivision.width);
+  double y = random.uniform(0,subdivision.height);
+  vector< pair<double,unsigned int> > distances(segments.size());
+  for(unsigned int i = 0; i < segments.size(); ++i) {
+    const Point2D& left = segments[i].getLeftEndPoint();
+    double dx = DefaultKernel::to_double(left.x) - x;
+    double dy = DefaultKernel::to_double(left.y) - y;
+    distances[i] = make_pair(dx * dx + dy * dy,i);
+  }
+  batch = min(batch,(unsigned int)segments.size());
+  partial_sort(distances.begin(),distances.begin() + batch,distances.end());
+  out.clear();
+  for(unsigned int i = 0; i < batch; ++i)
+    out.push_back(segments[distances[i].second]);
+}
+
+int main(int argc, char** argv) {
+  unsigned int size = 1000000;
+  unsigned int count = 1000000;
+  unsigned int shape = 1;
+  unsigned int largest = 10000;
+  if(argc > 1)
+    size = atoi(argv[1]);
+  if(argc > 2)
+    count = atoi(argv[2]);
+  if(argc > 3)
+    shape = atoi(argv[3]);
+  if(argc > 4)
+    largest = atoi(argv[4]);
+  if(shape >= bench::SHAPE_COUNT) {
+    cerr << "shape must be less than " << bench::SHAPE_COUNT << endl;
+    return 1;
+  }
+
+  Subdivision subdivision;
+  bench::SHAPES[shape].generate(size,size,subdivision);
+  const vector<LineSegment>& segments = subdivision.segments;
+  vector<Point2D> points;
+  bench::queries(subdivision,count,1,points);
+
+  PolygonalSubdivision ps;
+  ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+  double start = seconds();
+  double relock;
+  try {
+    ps.lock();
+    ps.freeze();
+    relock = seconds() - start;
+  } catch(string str) {
+    cerr << bench::SHAPES[shape].name << ": " << str << endl;
+    return 1;
+  } catch(const char* str) {
+    cerr << bench::SHAPES[shape].name << ": " << str << endl;
+    return 1;
+  }
+
+  vector<QueryResult> expected(points.size());
+  start = seconds();
+  for(unsigned int i = 0; i < points.size(); ++i)
+    expected[i] = ps.locate_point(points[i]);
+  double frozen = (seconds() - start) * 1e9 / points.size();
+
+  cout << bench::SHAPES[shape].name << ", " << segments.size()
+       << " segments, " << points.size() << " queries, "
+       << relock << " s to lock and freeze, " << frozen << " ns/query"
+       << endl;
+  cout << setw(10) << "batch" << setw(12) << "remove s"
+       << setw(12) << "insert s" << setw(12) << "speedup"
+       << setw(12) << "ns/query" << endl;
+
+  bench::Random random(size);
+  vector<LineSegment> batch;
+  vector<QueryResult> results(points.size());
+  for(unsigned int k = 1; k <= largest && k <= segments.size(); k *= 10) {
+    window(subdivision,k,random,batch);
+    double removed, inserted;
+    try {
+      start = seconds();
+      ps.update(0,0,&batch[0],&batch[0] + batch.size());
+      removed = seconds() - start;
+      start = seconds();
+      ps.update(&batch[0],&batch[0] + batch.size(),0,0);
+      inserted = seconds() - start;
+    } catch(string str) {
+      cerr << "batch " << k << ": " << str << endl;
+      return 1;
+    } catch(const char* str) {
+      cerr << "batch " << k << ": " << str << endl;
+      return 1;
+    }
+
+    start = seconds();
+    for(unsigned int i = 0; i < points.size(); ++i)
+      results[i] = ps.locate_point(points[i]);
+    double updated = (seconds() - start) * 1e9 / points.size();
+    for(unsigned int i = 0; i < points.size(); ++i)
+      if(results[i].outer != expected[i].outer ||
+	 !sameSegment(ps,results[i].above,ps,expected[i].above) ||
+	 !sameSegment(ps,results[i].below,ps,expected[i].below)) {
+	cerr << "batch " << k << ": wrong answer for query " << i << endl;
+	return 1;
+      }
+    cout << setw(10) << k << setw(12) << removed << setw(12) << inserted
+	 << setw(12) << relock / (removed + inserted)
+	 << setw(12) << updated << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    generate.cpp                                                     //
+//                                                                           //
+// MODULE:  Benchmarks                                                       //
+//                                                                           //
+// NOTES:   Writes a shape of Generators.hpp to a segments file and query    //
+//          points for it to a points file, in the format the tests read,    //
+//          so that the tests which take files can run without the data of   //
+//          DATA_DIR.  The points are random ones in the bounding box        //
+//          followed by the end points of every seventh segment, so that     //
+//          the queries also meet vertices.                                  //
+//                                                                           //
+//          usage: generate [shape] [segments] [queries] [segments file]     //
+//                          [points file]                                    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "Generators.hpp"
+
+using namespace std;
+using namespace geometry;
+
+void write(ostream& out, const Point2D& p) {
+  out << p.x << " " << p.y;
+}
+
+int main(int argc, char** argv) {
+  if(argc < 6) {
+    cerr << "usage: " << argv[0]
+	 << " [shape] [segments] [queries] [segments file] [points file]"
+	 << endl;
+    return 1;
+  }
+  unsigned int shape = atoi(argv[1]);
+  unsigned int size = atoi(argv[2]);
+  unsigned int count = atoi(argv[3]);
+  if(shape >= bench::SHAPE_COUNT) {
+    cerr << "shape must be less than " << bench::SHAPE_COUNT << endl;
+    return 1;
+  }
+
+  bench::Subdivision subdivision;
+  bench::SHAPES[shape].generate(size,size,subdivision);
+  const vector<LineSegment>& segments = subdivision.segments;
+  vector<Point2D> points;
+  bench::queries(subdivision,count,count,points);
+
+  ofstream segment_file(argv[4]);
+  for(unsigned int i = 0; i < segments.size(); ++i) {
+    write(segment_file,segments[i].getFirstEndPoint());
+    segment_file << " ";
+    write(segment_file,segments[i].getSecondEndPoint());
+    segment_file << endl;
+  }
+  ofstream point_file(argv[5]);
+  for(unsigned int i = 0; i < points.size(); ++i) {
+    write(point_file,points[i]);
+    point_file << endl;
+  }
+  for(unsigned int i = 0; i < segments.size(); i += 7) {
+    write(point_file,segments[i].getFirstEndPoint());
+    point_file << endl;
+  }
+  if(!segment_file || !point_file) {
+    cerr << "could not write " << argv[4] << " and " << argv[5] << endl;
+    return 1;
+  }
+  return 0;
+}
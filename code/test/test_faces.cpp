@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    test_faces.cpp                                                   //
+//                                                                           //
+// MODULE:  Polygonal Subdivision                                            //
+//                                                                           //
+// NOTES:   Labels the faces of a small subdivision whose IDs are worked     //
+//          out by hand, rather than compared with another engine, and       //
+//          checks face_count(), the faces on both sides of each segment     //
+//          and the face of points in each, on every engine.  Two trees      //
+//          start at a vertical segment which rises to a horizontal one,     //
+//          one inside a square and one outside, so that a ray shot up from  //
+//          their first vertex would meet the tree itself.                   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <string>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+
+using namespace std;
+using namespace geometry;
+
+// Square A, from (0,0) to (10,10), holds a tree and square B, from
+// (7,1) to (9,3).  Right of A stand another tree and triangle D.  The
+// bounded faces are numbered in the order of the handles of their
+// first segments, which are the bottoms of A, B and D, as the handles
+// of the vertical segments come after those of the others: 1 inside
+// A, 2 inside B and 3 inside D.
+const int SEGMENTS[][4] = {
+  // square A, inside which is face 1
+  { 0, 0, 10, 0 }, { 10, 0, 10, 10 }, { 0, 10, 10, 10 }, { 0, 0, 0, 10 },
+  // a tree in face 1
+  { 3, 2, 3, 5 }, { 3, 5, 6, 5 },
+  // square B in face 1, inside which is face 2
+  { 7, 1, 9, 1 }, { 9, 1, 9, 3 }, { 7, 3, 9, 3 }, { 7, 1, 7, 3 },
+  // a tree in the unbounded face
+  { 15, 0, 15, 8 }, { 15, 8, 18, 8 },
+  // triangle D, inside which is face 3
+  { 20, 0, 26, 0 }, { 20, 0, 20, 6 }, { 20, 6, 26, 0 }
+};
+const unsigned int SEGMENT_COUNT = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+const unsigned int FACE_COUNT = 4;
+
+// the faces above and below each segment, or left and right of a
+// vertical one, in the order of SEGMENTS
+const unsigned int SIDES[][2] = {
+  { 1, 0 }, { 1, 0 }, { 0, 1 }, { 0, 1 },
+  { 1, 1 }, { 1, 1 },
+  { 2, 1 }, { 2, 1 }, { 1, 2 }, { 1, 2 },
+  { 0, 0 }, { 0, 0 },
+  { 3, 0 }, { 0, 3 }, { 0, 3 }
+};
+
+// points away from the sweep lines, and the faces containing them
+const int POINTS[][3] = {
+  { 5, 8, 1 }, { 4, 4, 1 }, { 4, 6, 1 }, { 1, 1, 1 }, { 8, 2, 2 },
+  { -5, 5, 0 }, { 12, 5, 0 }, { 16, 4, 0 }, { 16, 9, 0 }, { 17, 1, 0 },
+  { 21, 1, 3 }, { 22, 3, 3 }, { 25, 5, 0 }, { 30, 1, 0 }
+};
+const unsigned int POINT_COUNT = sizeof(POINTS) / sizeof(POINTS[0]);
+
+// whether a locked subdivision of the segments has the faces above
+bool check(const char* name, const PolygonalSubdivision& ps) {
+  bool ok = true;
+  if(ps.face_count() != FACE_COUNT) {
+    cout << name << ": " << ps.face_count() << " faces, not "
+	 << FACE_COUNT << endl;
+    ok = false;
+  }
+  // the handles are not in the order the segments were added
+  for(unsigned int h = 0; h < SEGMENT_COUNT; ++h) {
+    unsigned int i = 0;
+    while(i < SEGMENT_COUNT &&
+	  !(ps.segment(h) == LineSegment(SEGMENTS[i][0],SEGMENTS[i][1],
+					 SEGMENTS[i][2],SEGMENTS[i][3])))
+      ++i;
+    if(i == SEGMENT_COUNT) {
+      cout << name << ": segment " << ps.segment(h) << " was not added"
+	   << endl;
+      ok = false;
+    } else if(ps.face_above(h) != SIDES[i][0] ||
+	      ps.face_below(h) != SIDES[i][1]) {
+      cout << name << ": segment " << ps.segment(h) << " has faces "
+	   << ps.face_above(h) << " and " << ps.face_below(h) << ", not "
+	   << SIDES[i][0] << " and " << SIDES[i][1] << endl;
+      ok = false;
+    }
+  }
+  for(unsigned int i = 0; i < POINT_COUNT; ++i) {
+    Point2D p(POINTS[i][0],POINTS[i][1]);
+    unsigned int face = ps.locate_point(p).face;
+    if(face != (unsigned int)POINTS[i][2]) {
+      cout << name << ": (" << p << ") is in face " << face << ", not "
+	   << POINTS[i][2] << endl;
+      ok = false;
+    }
+  }
+  cout << name << ": " << (ok ? "ok" : "wrong") << endl;
+  return ok;
+}
+
+int main() {
+  vector<LineSegment> segments;
+  for(unsigned int i = 0; i < SEGMENT_COUNT; ++i)
+    segments.push_back(LineSegment(SEGMENTS[i][0],SEGMENTS[i][1],
+				   SEGMENTS[i][2],SEGMENTS[i][3]));
+
+  PolygonalSubdivision ps;
+  PolygonalSubdivision frozen;
+  PolygonalSubdivision trapezoidal(PolygonalSubdivision::TRAPEZOIDAL_MAP);
+  PolygonalSubdivision hierarchy(PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  // the kernel may not support the hierarchy, which is then left out
+  bool with_hierarchy = PolygonalSubdivision::supports(
+    PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  try {
+    const LineSegment* begin = &segments[0];
+    const LineSegment* end = begin + segments.size();
+    ps.addLineSegments(begin,end);
+    frozen.addLineSegments(begin,end);
+    trapezoidal.addLineSegments(begin,end);
+    if(with_hierarchy)
+      hierarchy.addLineSegments(begin,end);
+    ps.lock();
+    frozen.lock();
+    frozen.freeze();
+    trapezoidal.lock();
+    if(with_hierarchy)
+      hierarchy.lock();
+  } catch(string str) {
+    cerr << "=== ERROR=== " << str << endl;
+    return 1;
+  } catch(const char* str) {
+    cerr << "=== ERROR=== " << str << endl;
+    return 1;
+  }
+
+  bool ok = true;
+  ok = check("persistent skip list",ps) && ok;
+  ok = check("frozen",frozen) && ok;
+  ok = check("trapezoidal map",trapezoidal) && ok;
+  if(with_hierarchy)
+    ok = check("triangulation hierarchy",hierarchy) && ok;
+  return ok ? 0 : 1;
+}
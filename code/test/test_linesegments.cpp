@@ -87,6 +87,36 @@ int main(int argc, char** argv) {
   assert(seg10.getTopEndPoint().y == 4);
   assert(seg10.getBottomEndPoint().y == 2);
 
+  assert(seg4.getFirstEndPoint().x == 3);
+  assert(seg4.getSecondEndPoint().x == 1);
+  assert(seg10.getFirstEndPoint().x == 3);
+  assert(seg10.getSecondEndPoint().y == 2);
+
+  // going down and to the right
+  LineSegment seg11(1,4,3,2);
+  assert(seg11.getLeftEndPoint().y == 4);
+  assert(seg11.getRightEndPoint().y == 2);
+  assert(seg11.getTopEndPoint().x == 1);
+  assert(seg11.getBottomEndPoint().x == 3);
+
+  // ties keep the second end point as the left and bottom one
+  LineSegment vertical(0,5,0,0);
+  assert(vertical.isVertical());
+  assert(vertical.getFirstEndPoint().y == 5);
+  assert(vertical.getLeftEndPoint().y == 0);
+  assert(vertical.getRightEndPoint().y == 5);
+  assert(vertical.getBottomEndPoint().y == 0);
+  assert(vertical.getTopEndPoint().y == 5);
+  assert(vertical == LineSegment(0,0,0,5));
+
+  LineSegment horizontal(4,1,2,1);
+  assert(horizontal.isHorizontal());
+  assert(horizontal.getLeftEndPoint().x == 2);
+  assert(horizontal.getBottomEndPoint().x == 2);
+  assert(horizontal.getTopEndPoint().x == 4);
+  assert(horizontal == LineSegment(2,1,4,1));
+  assert(horizontal != LineSegment(2,1,4,2));
+
   vector<LineSegment> lsVector;
   lsVector.push_back(seg1);
   lsVector.push_back(seg2);
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    test_point2d.cpp                                                 //
+//                                                                           //
+// MODULE:  Geometry                                                         //
+//                                                                           //
+// NOTES:   None.                                                            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <iostream>
+#include "../Point2D.hpp"
+
+using namespace std;
+using namespace geometry;
+
+// exercises the predicates every kernel must get right
+template <class Kernel>
+void testOrientation() {
+  typedef BasicPoint2D<Kernel> point_t;
+  point_t a(0,0);
+  point_t b(4,0);
+  point_t above(2,3);
+  point_t below(2,-3);
+  point_t on(6,0);
+
+  assert(point_t::orientation(a,b,above) == 1);
+  assert(point_t::orientation(a,b,below) == -1);
+  assert(point_t::orientation(b,a,above) == -1);
+  assert(point_t::orientation(a,b,on) == 0);
+  assert(point_t::leftTurn(a,b,above));
+  assert(point_t::rightTurn(a,b,below));
+  assert(point_t::colinear(a,b,on));
+  assert(!point_t::colinear(a,b,above));
+}
+
+int main(int argc, char** argv) {
+  testOrientation<Int64Kernel>();
+  testOrientation<DoubleKernel>();
+  testOrientation<DefaultKernel>();
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Test the int64 kernel where double precision is not enough              //
+  /////////////////////////////////////////////////////////////////////////////
+  {
+    typedef BasicPoint2D<Int64Kernel> point_t;
+    int64_t big = int64_t(1) << 61;
+    point_t p(0,0);
+    point_t q(big,big - 1);
+    // one unit above the line through p and q near its far end
+    point_t r(big - 1,big - 1);
+    assert(point_t::orientation(p,q,r) == 1);
+    assert(point_t::orientation(p,q,point_t(-big,-big + 1)) == 0);
+  }
+
+#ifndef GEOMETRY_NO_LEDA
+  typedef BasicPoint2D<RationalKernel> Point2D;
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Test orientation away from degeneracy                                   //
+  /////////////////////////////////////////////////////////////////////////////
+  Point2D a(0,0);
+  Point2D b(4,0);
+  Point2D above(2,3);
+  Point2D below(2,-3);
+  Point2D on(6,0);
+
+  PredicateStatistics::reset();
+  assert(Point2D::orientation(a,b,above) == 1);
+  assert(Point2D::orientation(a,b,below) == -1);
+  assert(Point2D::leftTurn(a,b,above));
+  assert(Point2D::rightTurn(a,b,below));
+  assert(!Point2D::colinear(a,b,above));
+#ifdef GEOMETRY_PREDICATE_STATISTICS
+  assert(PredicateStatistics::evaluations == 5);
+#endif
+  assert(PredicateStatistics::filter_failures == 0);
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Test that degenerate cases fall back to exact arithmetic                //
+  /////////////////////////////////////////////////////////////////////////////
+  PredicateStatistics::reset();
+  assert(Point2D::orientation(a,b,on) == 0);
+  assert(Point2D::colinear(a,b,on));
+  assert(PredicateStatistics::filter_failures == 2);
+
+  // thirds are not representable in double, but the points are colinear
+  rational third = rational(1) / rational(3);
+  Point2D p(third,third);
+  Point2D q(third * rational(7),third * rational(7));
+  Point2D r(third * rational(13),third * rational(13));
+  assert(Point2D::orientation(p,q,r) == 0);
+
+  // a perturbation far below double precision must still be detected
+  rational tiny(1);
+  for(int i = 0; i < 17; ++i)
+    tiny = tiny / rational(10);
+  Point2D r_above(r.x, r.y + tiny);
+  Point2D r_below(r.x, r.y - tiny);
+  assert(Point2D::orientation(p,q,r_above) == 1);
+  assert(Point2D::orientation(p,q,r_below) == -1);
+  assert(Point2D::orientation(q,p,r_above) == -1);
+
+  cout << "evaluations: " << PredicateStatistics::evaluations
+       << ", filter failures: " << PredicateStatistics::filter_failures
+       << endl;
+#endif
+
+  return 0;
+}
@@ -12,12 +12,16 @@
 //                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <cstdio>
 #include <iostream>
 #include <iterator>
+#include <vector>
 #include <ctime>
 #include "../Point2D.hpp"
 #include "../LineSegment.hpp"
 #include "../PolygonalSubdivision.hpp"
+#include "../ThreadPool.hpp"
+#include "../Trace.hpp"
 
 using namespace std;
 using namespace geometry;
@@ -28,37 +32,59 @@ int main(int argc, char** argv) {
     cerr << "usage: " << argv[0] << " [segments file] [points file]" << endl
 	 << "\t where [segments file] is a file containing line segments" << endl
 	 << "\t and   [points file]   is a file containing query points" << endl;
-    return 0;
+    return 1;
   }
   time_t start = time(0);
   time_t last = start;
-  // for segment input
+  // for segment input, through operator>> to check the bulk readers
   ifstream segment_file(argv[1]);
   istream_iterator<LineSegment> segment_begin(segment_file);
   istream_iterator<LineSegment> segment_end;
+  vector<LineSegment> segments(segment_begin,segment_end);
   
   // for point input
   ifstream point_file(argv[2]);
   istream_iterator<Point2D> point_begin(point_file);
   istream_iterator<Point2D> point_end;
   
+  concurrency::ThreadPool pool(4);
   PolygonalSubdivision ps;
+  // built in bands on several threads, it must answer like ps
+  PolygonalSubdivision banded;
+  // and so must a frozen subdivision, and the other engines
+  PolygonalSubdivision frozen;
+  PolygonalSubdivision trapezoidal(PolygonalSubdivision::TRAPEZOIDAL_MAP);
+  PolygonalSubdivision hierarchy(PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  // the kernel may not support the hierarchy, which is then left out
+  bool with_hierarchy = PolygonalSubdivision::supports(
+    PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  // a copy of frozen, saved to a file and loaded back
+  PolygonalSubdivision loaded;
+  // never locked, and queried in one offline sweep
+  PolygonalSubdivision offline;
 
-  // read in the segments
-  while(segment_begin != segment_end) {
-    try{
-      ps.addLineSegment(*segment_begin);
-    } catch(char const* str) {
-      cerr << "=== ERROR=== " << str <<endl;
-      return 1;
-    }
-    ++segment_begin;
+  // read in the segments, in each of the ways segments can be added
+  try{
+    ps.addLineSegments(argv[1]);
+    banded.addLineSegments(argv[1],pool);
+    for(unsigned int i = 0; i < segments.size(); ++i)
+      frozen.addLineSegment(segments[i]);
+    if(!segments.empty())
+      trapezoidal.addLineSegments(&segments[0],&segments[0] + segments.size());
+    if(!segments.empty())
+      offline.addLineSegments(&segments[0],&segments[0] + segments.size());
+    if(with_hierarchy)
+      hierarchy.addLineSegments(segments);
+  } catch(string str) {
+    cerr << "=== ERROR=== " << str <<endl;
+    return 1;
   }
   // ready the structure for queries
   try {
     ps.lock();
   } catch(string str) {
     cerr << "=== ERROR=== " << str << endl;
+    trace::dump(cerr);
     return 2;
   }
 
@@ -66,21 +92,49 @@ int main(int argc, char** argv) {
   cerr << "Build took: " << difftime(now,last) << endl;
   last = now;
 
+  try {
+    banded.lock(pool);
+    frozen.lock();
+    frozen.freeze();
+    trapezoidal.lock();
+    if(with_hierarchy)
+      hierarchy.lock();
+    frozen.save("snapshot_PS.bin");
+    loaded.load("snapshot_PS.bin");
+    // the mapping outlives the file
+    remove("snapshot_PS.bin");
+  } catch(string str) {
+    cerr << "=== ERROR=== " << str << endl;
+    trace::dump(cerr);
+    return 2;
+  }
+
+  now = time(0);
+  cerr << "Other builds took: " << difftime(now,last) << endl;
+  last = now;
+
   // locate and print the containing polygon for each point
+  vector<Point2D> points;
+  vector<QueryResult> results;
   while(point_begin != point_end) {
     try{
       cout << "(" << *point_begin << "): ";
       QueryResult result = ps.locate_point(*point_begin);
+      points.push_back(*point_begin);
+      results.push_back(result);
       if(result.outer)
 	cout << "outer" << endl;
       else if(result.vertex)
-	cout << "Vertex" << endl;
+	cout << "Vertex, face " << result.face << endl;
       else if(result.edge)
-	cout << "Edge: (" << result.above << ")" << endl;
+	cout << "Edge: (" << ps.segment(result.above) << "), face "
+	     << result.face << endl;
       else
-	cout << "(" << result.above << ") (" << result.below << ")" << endl;
+	cout << "(" << ps.segment(result.above) << ") ("
+	     << ps.segment(result.below) << "), face " << result.face << endl;
     }catch(char const* str) {
       cerr << "=== ERROR === " << str << endl;
+      trace::dump(cerr);
       return 3;
     }
     ++point_begin;
@@ -88,6 +142,86 @@ int main(int argc, char** argv) {
 
   now = time(0);
   cerr << "Queries took: " << difftime(now,last) << endl;
+  last = now;
+
+  // the batch queries must agree with the single queries
+  if(!points.empty()) {
+    vector<QueryResult> batch(points.size());
+    vector<QueryResult> parallel(points.size());
+    vector<QueryResult> from_bands(points.size());
+    vector<QueryResult> from_index(points.size());
+    vector<QueryResult> from_map(points.size());
+    vector<QueryResult> from_hierarchy(points.size());
+    vector<QueryResult> from_snapshot(points.size());
+    vector<QueryResult> from_sweep(points.size());
+    // in groups of 7, so that the last group of most batches is short
+    vector<QueryResult> interleaved(points.size());
+    try{
+      ps.locate_points(&points[0],&points[0] + points.size(),&batch[0]);
+      ps.locate_points(&points[0],&points[0] + points.size(),&parallel[0],
+		       pool);
+      banded.locate_points(&points[0],&points[0] + points.size(),
+			   &from_bands[0]);
+      frozen.locate_points(&points[0],&points[0] + points.size(),
+			   &from_index[0]);
+      frozen.locate_points_interleaved(&points[0],
+				       &points[0] + points.size(),
+				       &interleaved[0],
+				       7);
+      trapezoidal.locate_points(&points[0],&points[0] + points.size(),
+				&from_map[0]);
+      if(with_hierarchy)
+	hierarchy.locate_points(&points[0],&points[0] + points.size(),
+				&from_hierarchy[0]);
+      loaded.locate_points(&points[0],&points[0] + points.size(),
+			   &from_snapshot[0]);
+      offline.locate_points_offline(&points[0],&points[0] + points.size(),
+				    &from_sweep[0]);
+    }catch(char const* str) {
+      cerr << "=== ERROR === " << str << endl;
+      return 3;
+    }
+    // hinted queries, each point twice, so the second starts where the
+    // first ended
+    QueryCursor cursor, frozen_cursor, map_cursor, hierarchy_cursor;
+    for(unsigned int i = 0; i < points.size(); ++i) {
+      for(unsigned int twice = 0; twice < 2; ++twice) {
+	if(ps.locate_point(points[i],cursor) != results[i] ||
+	   frozen.locate_point(points[i],frozen_cursor) != results[i] ||
+	   trapezoidal.locate_point(points[i],map_cursor) != results[i] ||
+	   (with_hierarchy &&
+	    hierarchy.locate_point(points[i],hierarchy_cursor) !=
+	    results[i])) {
+	  cerr << "=== ERROR === hinted query disagrees at (" << points[i]
+	       << ")" << endl;
+	  return 4;
+	}
+      }
+    }
+    for(unsigned int i = 0; i < points.size(); ++i) {
+      if(batch[i] != results[i] ||
+	 parallel[i] != results[i] ||
+	 from_bands[i] != results[i] ||
+	 from_index[i] != results[i] ||
+	 interleaved[i] != results[i] ||
+	 frozen.locate_point(points[i]) != results[i] ||
+	 from_map[i] != results[i] ||
+	 trapezoidal.locate_point(points[i]) != results[i] ||
+	 (with_hierarchy &&
+	  (from_hierarchy[i] != results[i] ||
+	   hierarchy.locate_point(points[i]) != results[i])) ||
+	 from_snapshot[i] != results[i] ||
+	 loaded.locate_point(points[i]) != results[i] ||
+	 from_sweep[i] != results[i]) {
+	cerr << "=== ERROR === batch query disagrees at (" << points[i] << ")"
+	     << endl;
+	return 4;
+      }
+    }
+  }
+
+  now = time(0);
+  cerr << "Batch queries took: " << difftime(now,last) << endl;
   cerr << "Total time: " << difftime(now,start) << endl;
   last = now;
   
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    test_query_allocations.cpp                                       //
+//                                                                           //
+// MODULE:  Polygonal Subdivision                                            //
+//                                                                           //
+// NOTES:   Counts the calls of operator new made while each engine locates  //
+//          the query points, one at a time and with a cursor, and fails if  //
+//          any query made one.  Each engine answers one query first, so     //
+//          that statics made on first use are not counted.  Memory which    //
+//          a coordinate type takes from its own allocator is not seen.      //
+//          The triangulation hierarchy is only checked with a kernel which  //
+//          supports it.                                                     //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "../bench/Measure.hpp"
+
+using namespace std;
+using namespace geometry;
+using bench::allocations;
+
+// the allocations made by the queries of points, one at a time and
+// then with a cursor
+bool check(const char* name,
+	   const PolygonalSubdivision& ps,
+	   const vector<Point2D>& points) {
+  ps.locate_point(points[0]);
+  unsigned long before = allocations;
+  for(unsigned int i = 0; i < points.size(); ++i)
+    ps.locate_point(points[i]);
+  unsigned long single = allocations - before;
+
+  PolygonalSubdivision::cursor_t cursor;
+  before = allocations;
+  for(unsigned int i = 0; i < points.size(); ++i)
+    ps.locate_point(points[i],cursor);
+  unsigned long hinted = allocations - before;
+
+  cout << name << ": " << single << " allocations in " << points.size()
+       << " queries, " << hinted << " with a cursor" << endl;
+  return single == 0 && hinted == 0;
+}
+
+int main(int argc, char** argv) {
+  if(argc < 3) {
+    cerr << "usage: " << argv[0] << " [segments file] [points file]" << endl
+	 << "\t where [segments file] is a file containing line segments" << endl
+	 << "\t and   [points file]   is a file containing query points" << endl;
+    return 1;
+  }
+
+  ifstream point_file(argv[2]);
+  istream_iterator<Point2D> point_begin(point_file);
+  istream_iterator<Point2D> point_end;
+  vector<Point2D> points(point_begin,point_end);
+  if(points.empty()) {
+    cerr << "no query points" << endl;
+    return 1;
+  }
+
+  PolygonalSubdivision ps;
+  PolygonalSubdivision frozen;
+  PolygonalSubdivision trapezoidal(PolygonalSubdivision::TRAPEZOIDAL_MAP);
+  PolygonalSubdivision hierarchy(PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  // the kernel may not support the hierarchy, which is then left out
+  bool with_hierarchy = PolygonalSubdivision::supports(
+    PolygonalSubdivision::TRIANGULATION_HIERARCHY);
+  try {
+    ps.addLineSegments(argv[1]);
+    frozen.addLineSegments(argv[1]);
+    trapezoidal.addLineSegments(argv[1]);
+    if(with_hierarchy)
+      hierarchy.addLineSegments(argv[1]);
+    ps.lock();
+    frozen.lock();
+    frozen.freeze();
+    trapezoidal.lock();
+    if(with_hierarchy)
+      hierarchy.lock();
+  } catch(string str) {
+    cerr << "=== ERROR=== " << str << endl;
+    return 1;
+  } catch(const char* str) {
+    cerr << "=== ERROR=== " << str << endl;
+    return 1;
+  }
+
+  bool ok = true;
+  ok = check("persistent skip list",ps,points) && ok;
+  ok = check("frozen",frozen,points) && ok;
+  ok = check("trapezoidal map",trapezoidal,points) && ok;
+  if(with_hierarchy)
+    ok = check("triangulation hierarchy",hierarchy,points) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    test_thread_pool.cpp                                             //
+//                                                                           //
+// MODULE:  Concurrency                                                      //
+//                                                                           //
+// NOTES:   Throws each kind of exception from the calling worker and from   //
+//          another one, and checks that run() throws it on the calling      //
+//          thread only once every worker has returned, and that the pool    //
+//          runs the next task as usual.                                     //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../ThreadPool.hpp"
+
+using namespace std;
+using concurrency::ThreadPool;
+
+const unsigned int WORKERS = 4;
+
+enum Kind { NOTHING, MESSAGE, STRING, BAD_ALLOC, RUNTIME_ERROR, INTEGER };
+
+const char* const KIND_NAMES[] = {
+  "nothing", "const char*", "string", "bad_alloc", "runtime_error", "int"
+};
+
+// one worker throws an exception of a kind, and the others return a
+// little later, so that run() would see them unfinished if it did not
+// wait for them
+class ThrowingTask : public ThreadPool::Task {
+public:
+  ThrowingTask(unsigned int thrower, Kind kind)
+    : finished(WORKERS,0),
+      _thrower(thrower),
+      _kind(kind)
+  {}
+
+  void run(unsigned int worker) {
+    if(worker == _thrower) {
+      switch(_kind) {
+      case NOTHING:
+	break;
+      case MESSAGE:
+	throw "a message";
+      case STRING:
+	throw string("a string");
+      case BAD_ALLOC:
+	throw std::bad_alloc();
+      case RUNTIME_ERROR:
+	throw std::runtime_error("a runtime error");
+      case INTEGER:
+	throw 7;
+      }
+    } else {
+      usleep(20000);
+    }
+    finished[worker] = 1;
+  }
+
+  // one byte each, as the workers set them at the same time
+  vector<char> finished;
+
+private:
+  unsigned int _thrower;
+  Kind _kind;
+};
+
+// the kind run() threw, and its text
+Kind run(ThreadPool& pool, ThrowingTask& task, string& text) {
+  text.clear();
+  try {
+    pool.run(task);
+  } catch(const char* message) {
+    text = message;
+    return MESSAGE;
+  } catch(const string& str) {
+    text = str;
+    return STRING;
+  } catch(const std::bad_alloc&) {
+    return BAD_ALLOC;
+  } catch(...) {
+    return INTEGER;
+  }
+  return NOTHING;
+}
+
+int main() {
+  ThreadPool pool(WORKERS);
+  const Kind kinds[] = { MESSAGE, STRING, BAD_ALLOC, RUNTIME_ERROR, INTEGER };
+  // a runtime_error arrives as the string of its what(), and an int as
+  // a message
+  const Kind expected[] = { MESSAGE, STRING, BAD_ALLOC, STRING, MESSAGE };
+  const char* const texts[] = {
+    "a message", "a string", "", "a runtime error", 0
+  };
+
+  bool ok = true;
+  for(unsigned int i = 0; i < 5; ++i)
+    for(unsigned int thrower = 0; thrower < 2; ++thrower) {
+      ThrowingTask task(thrower,kinds[i]);
+      string text;
+      Kind thrown = run(pool,task,text);
+      bool waited = true;
+      for(unsigned int w = 0; w < WORKERS; ++w)
+	if(w != thrower && !task.finished[w])
+	  waited = false;
+      bool same = thrown == expected[i] &&
+	(texts[i] == 0 ? !text.empty() : text == texts[i]);
+      cout << KIND_NAMES[kinds[i]] << " from worker " << thrower
+	   << ": caught " << KIND_NAMES[thrown]
+	   << (text.empty() ? "" : " \"" + text + "\"")
+	   << (waited ? "" : ", before the other workers returned") << endl;
+      if(!same || !waited)
+	ok = false;
+
+      // the pool is left ready for the next task
+      ThrowingTask next(WORKERS,NOTHING);
+      if(run(pool,next,text) != NOTHING) {
+	cout << "the next task threw" << endl;
+	ok = false;
+      }
+      for(unsigned int w = 0; w < WORKERS; ++w)
+	if(!next.finished[w]) {
+	  cout << "worker " << w << " did not run the next task" << endl;
+	  ok = false;
+	}
+    }
+  return ok ? 0 : 1;
+}
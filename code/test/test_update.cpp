@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////////
+//                       Copyright (c) 2011 - 2012 by                        //
+//                                Simon Pratt                                //
+//                           (All rights reserved)                           //
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// FILE:    test_update.cpp                                                  //
+//                                                                           //
+// MODULE:  Polygonal Subdivision                                            //
+//                                                                           //
+// NOTES:   Removes and adds back every few segments of a frozen             //
+//          subdivision over several updates, and after each compares the    //
+//          answers to the query points with those of a subdivision locked   //
+//          with the present segments: the same flags, the same segments     //
+//          above and below, and faces which map one to one.  During each    //
+//          update, another thread locates the points, and each of its       //
+//          answers must be the one from before the update or after it.      //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../Point2D.hpp"
+#include "../LineSegment.hpp"
+#include "../PolygonalSubdivision.hpp"
+#include "../ThreadPool.hpp"
+
+using namespace std;
+using namespace geometry;
+
+// the segment of a handle, which is NONE in both or neither
+bool sameSegment(const PolygonalSubdivision& a, unsigned int s,
+		 const PolygonalSubdivision& b, unsigned int t) {
+  if(s == PolygonalSubdivision::NONE || t == PolygonalSubdivision::NONE)
+    return s == t;
+  return a.segment(s) == b.segment(t);
+}
+
+// whether the updated subdivision answers as one locked with segments
+bool check(const char* round,
+	   const PolygonalSubdivision& updated,
+	   const vector<LineSegment>& segments,
+	   const vector<Point2D>& points) {
+  PolygonalSubdivision fresh;
+  fresh.addLineSegments(&segments[0],&segments[0] + segments.size());
+  fresh.lock();
+  fresh.freeze();
+
+  map<unsigned int, unsigned int> faces;
+  map<unsigned int, unsigned int> back;
+  for(unsigned int i = 0; i < points.size(); ++i) {
+    QueryResult a = updated.locate_point(points[i]);
+    QueryResult b = fresh.locate_point(points[i]);
+    bool same = a.outer == b.outer && a.vertex == b.vertex &&
+      a.edge == b.edge &&
+      sameSegment(updated,a.above,fresh,b.above) &&
+      sameSegment(updated,a.below,fresh,b.below);
+    if(same && !faces.count(a.face) && !back.count(b.face)) {
+      faces[a.face] = b.face;
+      back[b.face] = a.face;
+    }
+    if(!same || faces[a.face] != b.face || back[b.face] != a.face) {
+      cerr << round << ": wrong answer for (" << points[i] << ")" << endl;
+      return false;
+    }
+  }
+  cout << round << ": " << segments.size() << " segments, "
+       << updated.face_count() << " face IDs, " << faces.size()
+       << " faces met" << endl;
+  return true;
+}
+
+// updates the subdivision on the calling thread while the other worker
+// locates the points until it is done
+class ConcurrentUpdate : public concurrency::ThreadPool::Task {
+public:
+  ConcurrentUpdate(PolygonalSubdivision& ps,
+		   const vector<Point2D>& points,
+		   const vector<LineSegment>& insert,
+		   const vector<LineSegment>& remove)
+    : seen(),
+      error(),
+      _ps(ps),
+      _points(points),
+      _insert(insert),
+      _remove(remove),
+      _done(false)
+  {}
+
+  void run(unsigned int worker) {
+    if(worker == 0) {
+      try {
+	_ps.update(_insert.empty() ? 0 : &_insert[0],
+		   _insert.empty() ? 0 : &_insert[0] + _insert.size(),
+		   _remove.empty() ? 0 : &_remove[0],
+		   _remove.empty() ? 0 : &_remove[0] + _remove.size());
+      } catch(string str) {
+	error = str;
+      } catch(const char* str) {
+	error = str;
+      }
+      __sync_synchronize();
+      _done = true;
+      return;
+    }
+    // the passes made while the update ran, and one after, of which
+    // the first few are kept
+    for(bool last = false; !last; ) {
+      last = _done;
+      bool keep = seen.size() < 64 * _points.size();
+      for(unsigned int i = 0; i < _points.size(); ++i) {
+	QueryResult result = _ps.locate_point(_points[i]);
+	if(keep)
+	  seen.push_back(result);
+      }
+    }
+  }
+
+  vector<QueryResult> seen;
+  string error;
+
+private:
+  PolygonalSubdivision& _ps;
+  const vector<Point2D>& _points;
+  const vector<LineSegment>& _insert;
+  const vector<LineSegment>& _remove;
+  volatile bool _done;
+};
+
+int main(int argc, char** argv) {
+  if(argc < 3) {
+    cerr << "usage: " << argv[0] << " [segments file] [points file]" << endl
+	 << "\t where [segments file] is a file containing line segments" << endl
+	 << "\t and   [points file]   is a file containing query points" << endl;
+    return 1;
+  }
+
+  ifstream segment_file(argv[1]);
+  istream_iterator<LineSegment> segment_begin(segment_file);
+  istream_iterator<LineSegment> segment_end;
+  vector<LineSegment> segments(segment_begin,segment_end);
+  ifstream point_file(argv[2]);
+  istream_iterator<Point2D> point_begin(point_file);
+  istream_iterator<Point2D> point_end;
+  vector<Point2D> points(point_begin,point_end);
+  if(segments.size() < 8 || points.empty()) {
+    cerr << "too few segments or points" << endl;
+    return 1;
+  }
+
+  concurrency::ThreadPool pool(2);
+  PolygonalSubdivision ps;
+  try {
+    ps.addLineSegments(&segments[0],&segments[0] + segments.size());
+    ps.lock();
+    ps.freeze();
+  } catch(string str) {
+    cerr << "=== ERROR=== " << str << endl;
+    return 2;
+  } catch(const char* str) {
+    cerr << "=== ERROR=== " << str << endl;
+    return 2;
+  }
+
+  // Each round removes the segments whose place in the file, less the
+  // round, is a multiple of its stride, and adds back those the last one
+  // removed.  The rounds which remove half of them or all but a few
+  // leave enough removed for the indexes to be compacted.
+  const unsigned int strides[] = { 5, 3, 7, 2, 1, 1000000 };
+  const unsigned int rounds = sizeof(strides) / sizeof(strides[0]);
+  vector<bool> present(segments.size(),true);
+  vector<LineSegment> removed;
+  for(unsigned int round = 0; round < rounds; ++round) {
+    vector<LineSegment> insert(removed);
+    vector<LineSegment> remove;
+    for(unsigned int i = 0; i < present.size(); ++i)
+      present[i] = true;
+    for(unsigned int i = round; i < segments.size(); i += strides[round])
+      present[i] = false;
+    for(unsigned int i = 0; i < segments.size(); ++i)
+      if(!present[i])
+	remove.push_back(segments[i]);
+    // those removed again are left out of both
+    for(unsigned int i = 0; i < insert.size(); ++i) {
+      unsigned int j = 0;
+      while(j < remove.size() && !(remove[j] == insert[i]))
+	++j;
+      if(j < remove.size()) {
+	remove.erase(remove.begin() + j);
+	insert.erase(insert.begin() + i--);
+      }
+    }
+    removed.clear();
+    for(unsigned int i = 0; i < segments.size(); ++i)
+      if(!present[i])
+	removed.push_back(segments[i]);
+
+    vector<QueryResult> before(points.size());
+    for(unsigned int i = 0; i < points.size(); ++i)
+      before[i] = ps.locate_point(points[i]);
+
+    ConcurrentUpdate task(ps,points,insert,remove);
+    pool.run(task);
+    if(!task.error.empty()) {
+      cerr << "=== ERROR=== " << task.error << endl;
+      return 1;
+    }
+    vector<QueryResult> after(points.size());
+    for(unsigned int i = 0; i < points.size(); ++i)
+      after[i] = ps.locate_point(points[i]);
+    for(unsigned int i = 0; i < task.seen.size(); ++i) {
+      const QueryResult& seen = task.seen[i];
+      if(seen != before[i % points.size()] &&
+	 seen != after[i % points.size()]) {
+	cerr << "round " << round << ": a query during the update found ("
+	     << points[i % points.size()] << ") in neither version" << endl;
+	return 1;
+      }
+    }
+
+    vector<LineSegment> now;
+    for(unsigned int i = 0; i < segments.size(); ++i)
+      if(present[i])
+	now.push_back(segments[i]);
+    stringstream name;
+    name << "round " << round << " (" << insert.size() << " added, "
+	 << remove.size() << " removed)";
+    if(!check(name.str().c_str(),ps,now,points))
+      return 1;
+  }
+
+  // a segment which is not there cannot be removed, and nothing changes
+  QueryResult before = ps.locate_point(points[0]);
+  try {
+    ps.update(0,0,&removed[0],&removed[0] + 1);
+    cerr << "removed a segment which was not there" << endl;
+    return 1;
+  } catch(string str) {
+    cout << "rejected: " << str << endl;
+  }
+  if(before != ps.locate_point(points[0])) {
+    cerr << "a rejected update changed the subdivision" << endl;
+    return 1;
+  }
+  return 0;
+}